@@ -33,6 +33,16 @@ namespace DnmGL::D3D12 {
         [[nodiscard]] auto GetState() const noexcept { return m_state; }
         [[nodiscard]] auto GetIdealState() const noexcept { return GetIdealBufferState(m_desc.usage_flags); }
     private:
+        uint8_t *IMap() override {
+            uint8_t *mapped_ptr{};
+            m_buffer->Map(0, nullptr, reinterpret_cast<void **>(&mapped_ptr));
+            return mapped_ptr;
+        }
+        void IUnmap() override { m_buffer->Unmap(0, nullptr); }
+        //upload and readback heaps are coherent
+        void IFlushRange(uint64_t, uint64_t) override {}
+        void IInvalidateRange(uint64_t, uint64_t) override {}
+
         ComPtr<ID3D12Resource2> m_buffer;
         D3D12MA::Allocation* m_allocation;
         
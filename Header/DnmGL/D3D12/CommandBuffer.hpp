@@ -16,6 +16,14 @@ namespace DnmGL::D3D12 {
         void IBeginRendering(const BeginRenderingDesc&) override;
         void IEndRendering() override;
 
+        //TODO: record recorders to separate command lists
+        std::span<DnmGL::CommandBuffer* const> IBeginParallelRendering(const BeginRenderingDesc& desc, uint32_t) override {
+            context->Message("parallel rendering is not supported in d3d12 context, recorders are not created", MessageType::eWarning);
+            IBeginRendering(desc);
+            return {};
+        }
+        void IEndParallelRendering() override { IEndRendering(); }
+
         void IBeginCopyPass() override {}
         void IEndCopyPass() override { DeferStateTranslation(); }
 
@@ -27,7 +35,7 @@ namespace DnmGL::D3D12 {
                         const void *data, 
                         Uint3 copy_extent, 
                         Uint3 copy_offset) override;
-        void IUploadData(DnmGL::Buffer *buffer, const void *data, uint32_t size, uint32_t offset) override;
+        void IUploadData(DnmGL::Buffer *buffer, const void *data, uint64_t size, uint64_t offset) override;
     
         void ICopyImageToBuffer(const DnmGL::ImageToBufferCopyDesc& desc) override;
         void ICopyImageToImage(const DnmGL::ImageToImageCopyDesc& desc) override;
@@ -37,8 +45,29 @@ namespace DnmGL::D3D12 {
         void IDispatch(uint32_t x = 1, uint32_t y = 1, uint32_t z = 1) override;
 
         void IBindPipeline(const DnmGL::ComputePipeline *pipeline) override;
+        //TODO: root descriptor
+        void IBindUniform(uint32_t, const TransientUniform&, uint32_t) override {
+            context->Message("transient uniforms are not supported in d3d12 context", MessageType::eWarning);
+        }
+        //TODO: root constants
+        void IPushConstants(const DnmGL::GraphicsPipeline *, uint32_t, std::span<const std::byte>) override {
+            context->Message("push constants are not supported in d3d12 context", MessageType::eWarning);
+        }
+        void IPushConstants(const DnmGL::ComputePipeline *, uint32_t, std::span<const std::byte>) override {
+            context->Message("push constants are not supported in d3d12 context", MessageType::eWarning);
+        }
 
         void IGenerateMipmaps(DnmGL::Image *image) override;
+
+        //TODO: readback heap ring
+        ReadbackHandle IRequestReadback(DnmGL::Buffer *, uint64_t, uint64_t) override {
+            context->Message("readbacks are not supported in d3d12 context", MessageType::eWarning);
+            return {};
+        }
+        ReadbackHandle IRequestReadback(DnmGL::Image *, const ImageSubresource&, Uint3, Uint3) override {
+            context->Message("readbacks are not supported in d3d12 context", MessageType::eWarning);
+            return {};
+        }
     
         void IBindVertexBuffer(const DnmGL::Buffer *buffer, uint64_t offset) override;
         void IBindIndexBuffer(const DnmGL::Buffer *buffer, uint64_t offset, DnmGL::IndexType index_type) override;
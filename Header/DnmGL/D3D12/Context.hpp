@@ -58,12 +58,53 @@ namespace DnmGL::D3D12 {
         void IInit(const ContextDesc&) override;
         void ISetSwapchainSettings(const SwapchainSettings& settings) override {}
 
-        void ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func) override;
-        void Render(const std::function<bool(DnmGL::CommandBuffer*)>& func) override;
+        uint64_t ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override;
+        uint64_t Render(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override;
+        //TODO: use copy queue
+        uint64_t ExecuteUploadCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override {
+            return ExecuteCommands(func, wait_tickets);
+        }
+        //TODO: use compute queue
+        uint64_t ExecuteComputeCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override {
+            return ExecuteCommands(func, wait_tickets);
+        }
+        //TODO: use ID3D12PipelineLibrary
+        bool SavePipelineCache() override { return false; }
+        //TODO: D3D12MA budget and IDXGIAdapter3::QueryVideoMemoryInfo
+        [[nodiscard]] MemoryStats GetMemoryStats() const override { return {}; }
+        //TODO: D3D12MA defragmentation
+        DefragmentationStats Defragment([[maybe_unused]] const DefragmentationDesc& desc = {}) override { 
+            return { .finished = true }; 
+        }
+        //d3d12 pipelines have no attachment op variants
+        bool SavePipelineManifest() override { return false; }
+        void WarmUpPipelines([[maybe_unused]] std::span<DnmGL::GraphicsPipeline* const> pipelines) override {}
+        //TODO: per-frame upload heap
+        using DnmGL::Context::AllocateUniform;
+        TransientUniform AllocateUniform(const void *, uint32_t) override {
+            Message("transient uniforms are not supported in d3d12 context", MessageType::eWarning);
+            return {};
+        }
+        //TODO: readback heap ring
+        [[nodiscard]] std::span<const std::byte> GetReadbackData([[maybe_unused]] ReadbackHandle handle) override { return {}; }
+        void ReleaseReadback([[maybe_unused]] ReadbackHandle handle) override {}
         void WaitForGPU() override;
+        [[nodiscard]] bool IsComplete(uint64_t ticket) noexcept override;
+        bool Wait(uint64_t ticket, uint64_t timeout = UINT64_MAX) override;
         
         [[nodiscard]] std::unique_ptr<DnmGL::Buffer> CreateBuffer(const DnmGL::BufferDesc&) noexcept override;
+        //TODO: ID3D12Device3::OpenExistingHeapFromAddress
+        [[nodiscard]] std::unique_ptr<DnmGL::Buffer> CreateBufferFromHostPointer(
+            [[maybe_unused]] const DnmGL::BufferDesc&, [[maybe_unused]] void *host_pointer) noexcept override {
+            Message("host pointer buffers are not supported in d3d12 context", MessageType::eWarning);
+            return nullptr;
+        }
         [[nodiscard]] std::unique_ptr<DnmGL::Image> CreateImage(const DnmGL::ImageDesc&) noexcept override;
+        //TODO: texture streaming
+        [[nodiscard]] std::unique_ptr<DnmGL::Image> CreateStreamingImage([[maybe_unused]] DnmGL::StreamingImageDesc&&) noexcept override {
+            Message("streaming images are not supported in d3d12 context", MessageType::eWarning);
+            return nullptr;
+        }
         [[nodiscard]] std::unique_ptr<DnmGL::Sampler> CreateSampler(const DnmGL::SamplerDesc&) noexcept override;
         [[nodiscard]] std::unique_ptr<DnmGL::Shader> CreateShader(std::string_view) noexcept override;
         [[nodiscard]] std::unique_ptr<DnmGL::ResourceManager> CreateResourceManager(std::span<const DnmGL::Shader*>) noexcept override;
@@ -152,6 +193,18 @@ namespace DnmGL::D3D12 {
         }
     }
 
+    inline bool Context::IsComplete(uint64_t ticket) noexcept {
+        return m_fence->GetCompletedValue() >= ticket;
+    }
+
+    inline bool Context::Wait(uint64_t ticket, uint64_t timeout) {
+        if (IsComplete(ticket)) return true;
+
+        const DWORD timeout_ms = timeout == UINT64_MAX ? INFINITE : DWORD(std::min<uint64_t>(timeout / 1'000'000, INFINITE - 1));
+        m_fence->SetEventOnCompletion(ticket, m_fence_event);
+        return WaitForSingleObject(m_fence_event, timeout_ms) == WAIT_OBJECT_0;
+    }
+
     inline D3D12::CommandBuffer* Context::GetCommandBufferIfRecording() {
         return (context_state == ContextState::eCommandBufferRecording) ? m_command_buffer : nullptr;
     }
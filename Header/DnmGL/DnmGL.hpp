@@ -5,6 +5,9 @@
 #include "DnmGL/Utility/Flag.hpp"
 #include "DnmGL/Utility/Math.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <functional>
@@ -13,6 +16,7 @@
 #include <format>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <variant>
 #include <filesystem>
 #include <fstream>
@@ -23,8 +27,6 @@
 #include <set>
 
 //TODO: add vulkan supported feature override
-//TODO: add per-frame buffer (vulkan dynamic buffer like something)
-//TODO: add push constant support (or alternative something)
 //TODO: test offline rendering for both api's
 //TODO: Vertex and Index buffers broken, pwease fix dis fow pwe-Tuwin’ GPUs (๑˃ᴗ˂)ﻭ ♡
 //TODO: D3D12 uniform and copy alighment problem
@@ -277,7 +279,14 @@ namespace DnmGL {
     enum class MemoryHostAccess : uint8_t {
         eNone,
         eReadWrite,
-        eWrite
+        eWrite,
+        //sequential writes go to device local memory (resizable bar), memory_type is ignored
+        //without host visible device local memory writes are staged, ranges passed to Buffer::FlushRange
+        //are copied to the buffer at the begin of next frame and overwrite gpu writes to those ranges
+        eDirectWrite,
+        //random reads from host cached memory, memory_type is ignored
+        //memory may not be coherent, call Buffer::InvalidateRange before reading gpu writes and Buffer::FlushRange after writing
+        eCachedRead,
     };
 
     enum class CommandBufferPassType : uint8_t {
@@ -285,6 +294,8 @@ namespace DnmGL {
         eTransfer,
         eCompute,
         eRendering,
+        //rendering pass recorded by secondary command buffers
+        eParallelRendering,
     };
 
     //same with vulkan
@@ -383,7 +394,6 @@ namespace DnmGL {
         eWritableImage,
         eUniformBuffer,
         eSampler,
-        //TODO: ePushConstant
     };
 
     enum class ContextState : uint8_t {
@@ -447,14 +457,23 @@ namespace DnmGL {
 
     struct ImageSubresource {
         ImageSubresourceType type = ImageSubresourceType::e2D;
-        uint8_t base_layer = 0;
+        uint16_t base_layer = 0;
         uint8_t base_mipmap = 0;
-        uint8_t layer_count = 1;
+        uint16_t layer_count = 1;
         uint8_t mipmap_level = 1;
 
         auto operator<=>(const ImageSubresource&) const = default;
     };
 
+    //every mip is allocated, mips are uploaded from the smallest to the biggest within ContextDesc::texture_streaming_budget per frame
+    //descriptors sample resident mips only until the biggest mip arrives
+    //CreateStreamingImage returns null if mip_data has not a big enough entry for every mip
+    struct StreamingImageDesc {
+        ImageDesc image_desc;
+        //tightly packed data of each mip, index is mip level, layers of a mip are consecutive
+        std::vector<std::vector<std::byte>> mip_data;
+    };
+
     struct RenderAttachment {
         DnmGL::Image *image;
         ImageSubresource subresource;
@@ -481,6 +500,8 @@ namespace DnmGL {
     struct FramebufferDesc {
         std::vector<ImageFormat> color_attachment_formats;
         ImageFormat depth_stencil_format;
+        //msaa color images share memory with framebuffers of the same formats and extent,
+        //loading them after another of those framebuffers is rendered gives undefined contents
         SampleCount msaa;
         Uint2 extent;
         //TODO: maybe i should have object create flags
@@ -488,11 +509,13 @@ namespace DnmGL {
     };
 
     struct BufferDesc {
-        uint32_t element_size;
-        uint32_t element_count;
+        uint64_t element_size;
+        uint64_t element_count;
         MemoryHostAccess memory_host_access;
         MemoryType memory_type;
         BufferUsageFlags usage_flags;
+
+        [[nodiscard]] constexpr uint64_t GetSize() const noexcept { return element_size * element_count; }
     };
 
     struct GpuMemoryDesc {
@@ -511,6 +534,12 @@ namespace DnmGL {
         ResourceType resource_type;
     };
 
+    //push constant block is not a descriptor, it is reflected as a byte range
+    struct PushConstantRange {
+        uint32_t offset;
+        uint32_t size;
+    };
+
     struct EntryPointInfo {
         std::string name;
         ShaderStageBits shader_stage;
@@ -518,26 +547,43 @@ namespace DnmGL {
         std::vector<BindingInfo> writable_resources;
         std::vector<BindingInfo> uniform_buffer_resources;
         std::vector<BindingInfo> sampler_resources;
+        std::optional<PushConstantRange> push_constant;
 
         constexpr bool HasReadonlyResource() const noexcept { return !readonly_resources.empty(); }
         constexpr bool HasWritableResource() const noexcept { return !writable_resources.empty(); }
         constexpr bool HasUniformResource() const noexcept { return !uniform_buffer_resources.empty(); }
         constexpr bool HasSamplerResource() const noexcept { return !sampler_resources.empty(); }
+        constexpr bool HasPushConstant() const noexcept { return push_constant.has_value(); }
     };
 
     struct UniformResourceDesc {
         DnmGL::Buffer *buffer;
-        uint32_t offset;
+        uint64_t offset;
         uint32_t size;
 
         uint32_t binding;
         uint32_t array_element;
     };
 
+    //allocated by Context::AllocateUniform, valid until the frame is completed
+    struct TransientUniform {
+        DnmGL::Buffer *buffer;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    //requested by CommandBuffer::RequestReadback, valid until Context::ReleaseReadback
+    struct ReadbackHandle {
+        //0 is invalid
+        uint64_t id{};
+
+        [[nodiscard]] constexpr bool IsValid() const noexcept { return id != 0; }
+    };
+
     struct ResourceDesc {
         Buffer *buffer;
-        uint32_t first_element;
-        uint32_t element_count;
+        uint64_t first_element;
+        uint64_t element_count;
         // or
         Image *image;
         ImageSubresource subresource;
@@ -594,8 +640,8 @@ namespace DnmGL {
     struct BufferToBufferCopyDesc {
         Buffer *src_buffer;
         Buffer *dst_buffer;
-        uint32_t src_offset;
-        uint32_t dst_offset;
+        uint64_t src_offset;
+        uint64_t dst_offset;
         uint64_t copy_size;
     };
 
@@ -603,7 +649,7 @@ namespace DnmGL {
         Buffer *src_buffer;
         Image *dst_image;
         ImageSubresource image_subresource;
-        uint32_t buffer_offset;
+        uint64_t buffer_offset;
         Uint3 copy_offset;
         Uint3 copy_extent;
     };
@@ -622,7 +668,7 @@ namespace DnmGL {
         Image *src_image;
         Buffer *dst_buffer;
         ImageSubresource image_subresource;
-        uint32_t buffer_offset;
+        uint64_t buffer_offset;
         Uint3 copy_offset;
         Uint3 copy_extent;
     };
@@ -651,6 +697,22 @@ namespace DnmGL {
             out |= presenting << 1;
             return out;
         }
+
+        //presenting is (packed & 0b10)
+        [[nodiscard]] static constexpr AttachmentOps FromPacked(uint32_t packed) noexcept {
+            AttachmentOps out{};
+            out.depth_load = AttachmentLoadOp((packed >> 30) & 0b11);
+            out.stencil_load = AttachmentLoadOp((packed >> 28) & 0b11);
+            for (uint32_t i{}; i < 8; i++) {
+                out.color_load[i] = AttachmentLoadOp((packed >> (26 - (i * 2))) & 0b11);
+            }
+            out.depth_store = AttachmentStoreOp((packed >> 11) & 0b1);
+            out.stencil_store = AttachmentStoreOp((packed >> 10) & 0b1);
+            for (uint32_t i{}; i < 8; i++) {
+                out.color_store[i] = AttachmentStoreOp((packed >> (9 - i)) & 0b1);
+            }
+            return out;
+        }
     };
 
     struct BeginRenderingDesc {
@@ -747,10 +809,179 @@ namespace DnmGL {
         bool operator<=>(const SwapchainSettings &) const = default;
     };
 
+    enum class AdapterType : uint8_t {
+        eOther,
+        eIntegrated,
+        eDiscrete,
+        eVirtual,
+        eCpu,
+    };
+
+    struct AdapterProperties {
+        std::string name;
+        //vulkan device uuid, d3d12 adapter luid in first 8 bytes
+        std::array<uint8_t, 16> uuid{};
+        //index in the enumeration order of the backend
+        uint32_t index{};
+        uint32_t vendor_id{};
+        uint32_t device_id{};
+        //total size of device local heaps
+        uint64_t dedicated_memory{};
+        AdapterType type{};
+    };
+
+    enum class MemoryCategory : uint8_t {
+        eVertexBuffer,
+        eIndexBuffer,
+        eUniformBuffer,
+        eWritableBuffer,
+        eReadonlyBuffer,
+        eImage,
+        //color and depth stencil images, including the ones owned by context
+        eAttachment,
+        //upload and readback memory owned by context
+        eStaging,
+        eCount,
+    };
+
+    struct MemoryCategoryStats {
+        uint64_t bytes{};
+        uint32_t allocation_count{};
+    };
+
+    //resources of a pool are sub-allocated from shared memory blocks
+    enum class MemoryPoolType : uint8_t {
+        eUniform,
+        eVertexIndex,
+        //writable and readonly buffers
+        eStorage,
+        //host memory buffers and staging memory owned by context
+        eStaging,
+        //color and depth stencil images
+        eRenderTarget,
+        eCount,
+    };
+
+    struct MemoryPoolDesc {
+        //size of memory blocks, 0 uses the allocator default
+        uint64_t block_size;
+        //resources of this size or bigger get their own memory, 0 never
+        uint64_t dedicated_threshold;
+    };
+
+    struct MemoryPoolSettings {
+        MemoryPoolDesc uniform{8 * 1024 * 1024, 1024 * 1024};
+        MemoryPoolDesc vertex_index{64 * 1024 * 1024, 16 * 1024 * 1024};
+        MemoryPoolDesc storage{64 * 1024 * 1024, 16 * 1024 * 1024};
+        MemoryPoolDesc staging{64 * 1024 * 1024, 32 * 1024 * 1024};
+        MemoryPoolDesc render_target{128 * 1024 * 1024, 32 * 1024 * 1024};
+
+        [[nodiscard]] constexpr const MemoryPoolDesc& operator[](MemoryPoolType type) const noexcept {
+            switch (type) {
+                case MemoryPoolType::eUniform: return uniform;
+                case MemoryPoolType::eVertexIndex: return vertex_index;
+                case MemoryPoolType::eStorage: return storage;
+                case MemoryPoolType::eStaging: return staging;
+                case MemoryPoolType::eRenderTarget:
+                case MemoryPoolType::eCount: return render_target;
+            }
+            std::unreachable();
+        }
+    };
+
+    struct MemoryPoolStats {
+        uint64_t block_bytes{};
+        uint64_t allocation_bytes{};
+        uint32_t block_count{};
+        uint32_t allocation_count{};
+    };
+
+    struct MemoryHeapStats {
+        //bytes the process can use without performance loss, estimated if driver doesn't report it
+        uint64_t budget{};
+        //bytes used by the process, including other apis and other libraries
+        uint64_t usage{};
+        //bytes of allocations made by context
+        uint64_t allocation_bytes{};
+        //bytes of memory blocks allocations are suballocated from
+        uint64_t block_bytes{};
+        uint32_t allocation_count{};
+        bool device_local{};
+    };
+
+    struct MemoryStats {
+        std::vector<MemoryHeapStats> heaps;
+        //buffers with several usages are counted in the first matching category
+        std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::eCount)> categories{};
+        //dedicated allocations and images that are not render targets are not in pools
+        std::array<MemoryPoolStats, static_cast<size_t>(MemoryPoolType::eCount)> pools{};
+        //peak bytes of staging memory in use at the same time
+        uint64_t staging_high_water_mark{};
+        //peak bytes of readback memory not released at the same time
+        uint64_t readback_high_water_mark{};
+        //bytes of transient attachments in lazily allocated memory, tile based gpus don't back them with physical memory
+        uint64_t lazily_allocated_bytes{};
+        //bytes saved by transient attachments of framebuffers sharing memory
+        uint64_t aliased_attachment_bytes{};
+
+        [[nodiscard]] constexpr const auto& operator[](MemoryCategory category) const noexcept { 
+            return categories[static_cast<size_t>(category)]; 
+        }
+        [[nodiscard]] constexpr const auto& operator[](MemoryPoolType pool) const noexcept { 
+            return pools[static_cast<size_t>(pool)]; 
+        }
+    };
+
+    //limits of one defragmentation pass, 0 is unlimited
+    struct DefragmentationDesc {
+        uint64_t max_bytes_per_pass = 16 * 1024 * 1024;
+        uint32_t max_allocations_per_pass = 64;
+        //cpu time spent preparing moves, remaining moves are left to the next passes
+        uint32_t max_microseconds_per_pass = 500;
+    };
+
+    struct DefragmentationStats {
+        //moved by the pass that ended in this call
+        uint64_t bytes_moved{};
+        uint32_t allocations_moved{};
+        //memory released by finished pools
+        uint64_t bytes_freed{};
+        //every pool is compacted, next call starts again
+        bool finished{};
+    };
+
     struct ContextDesc {
         WindowHandle window_handle;
         std::filesystem::path shader_directory;
         SwapchainSettings swapchain_settings;
+        //frames can be recorded while previous frames executing
+        //host visible resources written every frame must not be used by frames in flight
+        uint32_t frames_in_flight = 1;
+        //creates separate queue for ExecuteComputeCommands if device has it
+        //resources are shared between queues, this can be slower on some devices
+        bool async_compute = false;
+        //forces adapter, highest scored adapter is used if not set or not suitable
+        //scored by type (discrete > integrated > virtual > cpu), dedicated memory and queues
+        std::optional<uint32_t> adapter_index{};
+        //has priority over adapter_index
+        //backend specific, must be AdapterProperties::uuid taken from same backend
+        //luid is not persistent in d3d12, it changes after reboot or driver update
+        std::optional<std::array<uint8_t, 16>> adapter_uuid{};
+        //pipeline cache is loaded from this file at Init and saved to it at destruction
+        //stale or corrupted caches are ignored, empty path disables the cache file
+        std::filesystem::path pipeline_cache_path{};
+        //pipeline variants (attachment ops) are loaded from this file at Init for WarmUpPipelines
+        std::filesystem::path pipeline_manifest_path{};
+        //records every created pipeline variant, saved to pipeline_manifest_path at destruction
+        bool record_pipeline_manifest = false;
+        //per-frame memory of Context::AllocateUniform
+        uint32_t transient_uniform_size = 1024 * 1024;
+        //block sizes and dedicated allocation thresholds of memory pools
+        MemoryPoolSettings memory_pools{};
+        //bytes of streaming image mips uploaded per frame, at least one mip is uploaded
+        uint64_t texture_streaming_budget = 8 * 1024 * 1024;
+        //initial bytes of readback memory, grows if readbacks are not released fast enough
+        uint64_t readback_ring_size = 16 * 1024 * 1024;
     };
 
     using CallbackFunc = std::function<void(std::string_view message, MessageType error, std::string_view source)>;
@@ -770,13 +1001,58 @@ namespace DnmGL {
         void SetSwapchainSettings(const SwapchainSettings &settings);
 
         //offline rendering
-        virtual void ExecuteCommands(const std::function<bool(CommandBuffer*)>& func) = 0;
+        //returns ticket of the submission, 0 if func returns false
+        //submission waits on the GPU until all wait_tickets are completed
+        virtual uint64_t ExecuteCommands(const std::function<bool(CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) = 0;
         //ExecuteCommands + present image
-        virtual void Render(const std::function<bool(CommandBuffer*)>& func) = 0;
+        virtual uint64_t Render(const std::function<bool(CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) = 0;
+        //records on transfer queue if device has it, only copy pass can be used
+        //written resources are handed off to the next ExecuteCommands or Render
+        //returns ticket of the upload, 0 if func returns false
+        virtual uint64_t ExecuteUploadCommands(const std::function<bool(CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) = 0;
+        //records on async compute queue if enabled, rendering pass cannot be used
+        //pass the ticket to wait_tickets of ExecuteCommands or Render for using the results
+        virtual uint64_t ExecuteComputeCommands(const std::function<bool(CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) = 0;
         virtual void WaitForGPU() = 0;
+        [[nodiscard]] virtual bool IsComplete(uint64_t ticket) noexcept = 0;
+        //returns false if timeout expired, timeout is nanoseconds
+        virtual bool Wait(uint64_t ticket, uint64_t timeout = UINT64_MAX) = 0;
+        //writes pipeline cache to ContextDesc::pipeline_cache_path, returns false if nothing is written
+        virtual bool SavePipelineCache() = 0;
+        //writes recorded pipeline variants to ContextDesc::pipeline_manifest_path, returns false if nothing is written
+        virtual bool SavePipelineManifest() = 0;
+        //budget and usage of memory heaps and memory used by each resource category
+        [[nodiscard]] virtual MemoryStats GetMemoryStats() const = 0;
+        //moves at most one pass of allocations to compact memory, call once per frame while not recording
+        //copies are recorded at the end of the next ExecuteCommands or Render, never waits for gpu
+        //descriptors of moved buffers and images are rewritten, persistently mapped buffers are not moved
+        //a pass ends in a later call after its frame is completed, old memory is released then
+        virtual DefragmentationStats Defragment(const DefragmentationDesc& desc = {}) = 0;
+        //creates variants of pipelines that are in the manifest in parallel, call before the first frame
+        //duplicate pipelines are warmed up once
+        virtual void WarmUpPipelines(std::span<DnmGL::GraphicsPipeline* const> pipelines) = 0;
+
+        //per-frame linear allocator for frequently changing uniforms, can be called while recording, thread safe
+        //bind with CommandBuffer::BindUniform, returns buffer as null if frame memory is exhausted
+        virtual TransientUniform AllocateUniform(const void *data, uint32_t size) = 0;
+        template <typename T>
+        TransientUniform AllocateUniform(const T& data) { return AllocateUniform(&data, sizeof(T)); }
+
+        //empty until the submission that requested the readback is completed, never waits for gpu
+        //image data is tightly packed, layers follow each other
+        [[nodiscard]] virtual std::span<const std::byte> GetReadbackData(ReadbackHandle handle) = 0;
+        [[nodiscard]] bool IsReadbackReady(ReadbackHandle handle) { return !GetReadbackData(handle).empty(); }
+        //memory of the readback is reused after the submission is completed, can be released before it is ready
+        virtual void ReleaseReadback(ReadbackHandle handle) = 0;
 
         [[nodiscard]] virtual std::unique_ptr<DnmGL::Buffer> CreateBuffer(const DnmGL::BufferDesc &) noexcept = 0;
+        //buffer uses host memory without copying if it is supported and host_pointer and buffer size are page aligned
+        //otherwise ranges passed to Buffer::FlushRange are copied to the buffer at the begin of next frame
+        //through staging memory (a host copy and a gpu copy of flushed bytes), GetMappedPtr returns host_pointer
+        //host memory must outlive the buffer and must not be written while submissions using the buffer are executing
+        [[nodiscard]] virtual std::unique_ptr<DnmGL::Buffer> CreateBufferFromHostPointer(const DnmGL::BufferDesc &, void *host_pointer) noexcept = 0;
         [[nodiscard]] virtual std::unique_ptr<DnmGL::Image> CreateImage(const DnmGL::ImageDesc &) noexcept = 0;
+        [[nodiscard]] virtual std::unique_ptr<DnmGL::Image> CreateStreamingImage(DnmGL::StreamingImageDesc &&) noexcept = 0;
         [[nodiscard]] virtual std::unique_ptr<DnmGL::Sampler> CreateSampler(const DnmGL::SamplerDesc &) noexcept = 0;
         [[nodiscard]] virtual std::unique_ptr<DnmGL::Shader> CreateShader(std::string_view) noexcept = 0;
         [[nodiscard]] virtual std::unique_ptr<DnmGL::ResourceManager> CreateResourceManager(std::span<const DnmGL::Shader*>) noexcept = 0;
@@ -789,6 +1065,9 @@ namespace DnmGL {
         [[nodiscard]] constexpr DnmGL::Sampler *GetPlaceholderSampler() const noexcept { return placeholder_sampler; };
         [[nodiscard]] constexpr const std::filesystem::path& GetShaderDirectory() const noexcept { return shader_directory; };
         [[nodiscard]] constexpr const auto& GetSwapchainSettings() const noexcept { return swapchain_settings; };
+        [[nodiscard]] constexpr bool IsHeadless() const noexcept { return headless; };
+        //properties of the adapter chosen at Init
+        [[nodiscard]] constexpr const AdapterProperties& GetAdapterProperties() const noexcept { return adapter_properties; };
         [[nodiscard]] constexpr std::filesystem::path GetShaderPath(std::string_view filename) const noexcept;
         constexpr void SetCallbackFunc(CallbackFunc func) noexcept { callback_func.swap(func); };
         constexpr void Message(
@@ -806,6 +1085,8 @@ namespace DnmGL {
         CallbackFunc callback_func{};
         std::filesystem::path shader_directory{};
         SwapchainSettings swapchain_settings{};
+        AdapterProperties adapter_properties{};
+        bool headless{};
     };
 
     constexpr std::filesystem::path Context::GetShaderPath(std::string_view filename) const noexcept {
@@ -866,8 +1147,22 @@ namespace DnmGL {
         template <typename T = uint8_t>
         [[nodiscard]] constexpr T *GetMappedPtr() const noexcept;
 
+        //host visible buffers are persistently mapped, Map and Unmap calls are counted
+        template <typename T = uint8_t>
+        [[nodiscard]] T *Map();
+        void Unmap();
+        //makes host writes visible to gpu, needed for non coherent memory and staged buffers
+        void FlushRange(uint64_t offset, uint64_t size);
+        //makes gpu writes visible to host after the submission is completed, only needed for non coherent memory
+        void InvalidateRange(uint64_t offset, uint64_t size);
+
         [[nodiscard]] constexpr const auto& GetDesc() const noexcept { return m_desc; }
     protected:
+        virtual uint8_t *IMap() = 0;
+        virtual void IUnmap() = 0;
+        virtual void IFlushRange(uint64_t offset, uint64_t size) = 0;
+        virtual void IInvalidateRange(uint64_t offset, uint64_t size) = 0;
+
         uint8_t *m_mapped_ptr;
 
         DnmGL::BufferDesc m_desc;
@@ -881,8 +1176,14 @@ namespace DnmGL {
         virtual ~Image() = default;
 
         [[nodiscard]] constexpr const auto& GetDesc() const noexcept { return m_desc; }
+        //smallest resident mip index, mipmap_levels if nothing is resident, always 0 for non streaming images
+        [[nodiscard]] constexpr auto GetResidentMip() const noexcept { return m_resident_mip; }
+        [[nodiscard]] constexpr bool IsFullyResident() const noexcept { return m_resident_mip == 0; }
+        //mips of subresource that are not resident are cut, at least one mip is kept
+        [[nodiscard]] constexpr ImageSubresource GetResidentSubresource(const ImageSubresource& subresource) const noexcept;
     protected:
         DnmGL::ImageDesc m_desc;
+        uint32_t m_resident_mip{};
     };
 
     class Sampler : public RHIObject {
@@ -922,6 +1223,7 @@ namespace DnmGL {
             m_shaders(shaders.begin(), shaders.end()) {}
         virtual ~ResourceManager() = default;
 
+        //can be called while frames are in flight, commands recorded before the call keep using previous resources
         void SetReadonlyResource(std::span<const ResourceDesc> update_resource);
         void SetWritableResource(std::span<const ResourceDesc> update_resource);
         void SetUniformResource(std::span<const UniformResourceDesc> update_resource);
@@ -994,6 +1296,11 @@ namespace DnmGL {
         void BeginRendering(const BeginRenderingDesc& desc);
         void EndRendering();
 
+        //returns recorders which can be filled from different threads, one thread per recorder
+        //recorders are executed in order and the pass is ended by EndRendering
+        //returns empty span if backend does not support it
+        std::span<CommandBuffer* const> BeginParallelRendering(const BeginRenderingDesc& desc, uint32_t recorder_count);
+
         void BeginCopyPass();
         void EndCopyPass();
 
@@ -1001,6 +1308,13 @@ namespace DnmGL {
         void EndComputePass();
 
         void BindPipeline(const DnmGL::ComputePipeline *pipeline);
+        //binds transient uniform to uniform binding of the bound pipeline without descriptor write
+        //binding must not be set by ResourceManager::SetUniformResource
+        void BindUniform(uint32_t binding, const TransientUniform& uniform, uint32_t array_element = 0);
+
+        //offset and data size must be multiple of 4, at most 128 bytes are guaranteed
+        void PushConstants(const DnmGL::GraphicsPipeline *pipeline, uint32_t offset, std::span<const std::byte> data);
+        void PushConstants(const DnmGL::ComputePipeline *pipeline, uint32_t offset, std::span<const std::byte> data);
 
         void Draw(uint32_t vertex_count, uint32_t instance_count);
         void DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t vertex_offset);
@@ -1016,10 +1330,17 @@ namespace DnmGL {
 
         void GenerateMipmaps(DnmGL::Image *image);
 
+        //copies to readback memory, data is read with Context::GetReadbackData a few frames later
+        [[nodiscard]] ReadbackHandle RequestReadback(DnmGL::Buffer *buffer, uint64_t offset, uint64_t size);
+        [[nodiscard]] ReadbackHandle RequestReadback(DnmGL::Image *image, 
+                                                    const ImageSubresource& subresource, 
+                                                    Uint3 copy_extent, 
+                                                    Uint3 copy_offset = {});
+
         void BindVertexBuffer(const DnmGL::Buffer *buffer, uint64_t offset);
         void BindIndexBuffer(const DnmGL::Buffer *buffer, uint64_t offset, DnmGL::IndexType index_type);
 
-        template <typename T> void UploadData(DnmGL::Buffer *buffer, std::span<const T> data, uint32_t offset);
+        template <typename T> void UploadData(DnmGL::Buffer *buffer, std::span<const T> data, uint64_t offset);
         //TODO: maybe has UploadImageData struct
         template <typename T> void UploadData(DnmGL::Image *image, 
                                                 const ImageSubresource& subresource,
@@ -1037,11 +1358,14 @@ namespace DnmGL {
                                 const void *data, 
                                 Uint3 copy_extent, 
                                 Uint3 copy_offset) = 0;
-        virtual void IUploadData(DnmGL::Buffer *buffer, const void *data, uint32_t size, uint32_t offset) = 0;
+        virtual void IUploadData(DnmGL::Buffer *buffer, const void *data, uint64_t size, uint64_t offset) = 0;
 
         virtual void IBeginRendering(const BeginRenderingDesc& desc) = 0;
         virtual void IEndRendering() = 0;
 
+        virtual std::span<CommandBuffer* const> IBeginParallelRendering(const BeginRenderingDesc& desc, uint32_t recorder_count) = 0;
+        virtual void IEndParallelRendering() = 0;
+
         virtual void IBeginCopyPass() = 0;
         virtual void IEndCopyPass() = 0;
 
@@ -1049,6 +1373,9 @@ namespace DnmGL {
         virtual void IEndComputePass() = 0;
 
         virtual void IBindPipeline(const DnmGL::ComputePipeline *pipeline) = 0;
+        virtual void IBindUniform(uint32_t binding, const TransientUniform& uniform, uint32_t array_element) = 0;
+        virtual void IPushConstants(const DnmGL::GraphicsPipeline *pipeline, uint32_t offset, std::span<const std::byte> data) = 0;
+        virtual void IPushConstants(const DnmGL::ComputePipeline *pipeline, uint32_t offset, std::span<const std::byte> data) = 0;
 
         virtual void IDraw(uint32_t vertex_count, uint32_t instance_count) = 0;
         virtual void IDrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t vertex_offset) = 0;
@@ -1064,6 +1391,12 @@ namespace DnmGL {
 
         virtual void IGenerateMipmaps(DnmGL::Image *image) = 0;
 
+        virtual ReadbackHandle IRequestReadback(DnmGL::Buffer *buffer, uint64_t offset, uint64_t size) = 0;
+        virtual ReadbackHandle IRequestReadback(DnmGL::Image *image, 
+                                                const ImageSubresource& subresource, 
+                                                Uint3 copy_extent, 
+                                                Uint3 copy_offset) = 0;
+
         virtual void IBindVertexBuffer(const DnmGL::Buffer *buffer, uint64_t offset) = 0;
         virtual void IBindIndexBuffer(const DnmGL::Buffer *buffer, uint64_t offset, DnmGL::IndexType index_type) = 0;
 
@@ -1072,6 +1405,12 @@ namespace DnmGL {
         ComputePipeline *active_compute_pipeline{};
         GraphicsPipeline *active_graphics_pipeline{};
         Framebuffer *active_framebuffer{};
+        //recorders of active parallel rendering pass
+        std::span<CommandBuffer* const> active_recorders{};
+        //recorder of parallel rendering, pass is owned by primary command buffer
+        bool is_recorder{};
+        //recorded by ExecuteComputeCommands
+        bool compute_queue{};
     };
 
     inline void CommandBuffer::Begin() {
@@ -1085,6 +1424,7 @@ namespace DnmGL {
                 case CommandBufferPassType::eTransfer: EndCopyPass(); break;
                 case CommandBufferPassType::eCompute: EndComputePass(); break;
                 case CommandBufferPassType::eRendering: EndRendering(); break;
+                case CommandBufferPassType::eParallelRendering: EndRendering(); break;
             }
         }
 
@@ -1094,6 +1434,7 @@ namespace DnmGL {
     inline void CommandBuffer::BeginRendering(const BeginRenderingDesc& desc) {
         DnmGLAssert(active_pass == CommandBufferPassType::eNone, 
         "BeginRendering cannot be call in some pass")
+        DnmGLAssert(!compute_queue, "BeginRendering cannot be call in ExecuteComputeCommands")
 
         IsValidBeginRenderingDesc(desc);
 
@@ -1104,15 +1445,50 @@ namespace DnmGL {
     }
 
     inline void CommandBuffer::EndRendering() {
-        DnmGLAssert(active_pass == CommandBufferPassType::eRendering, 
+        DnmGLAssert(active_pass == CommandBufferPassType::eRendering
+                || active_pass == CommandBufferPassType::eParallelRendering, 
         "BeginRendering must be called before EndRendering")
+        DnmGLAssert(!is_recorder, "recorders are ended by EndRendering of primary command buffer")
 
         active_graphics_pipeline = nullptr;
         active_framebuffer = nullptr;
-        IEndRendering();
+        if (active_pass == CommandBufferPassType::eParallelRendering) {
+            IEndParallelRendering();
+            for (auto* recorder : active_recorders) {
+                recorder->active_graphics_pipeline = nullptr;
+                recorder->active_framebuffer = nullptr;
+                recorder->active_pass = CommandBufferPassType::eNone;
+            }
+            active_recorders = {};
+        }
+        else
+            IEndRendering();
         active_pass = CommandBufferPassType::eNone;
     }
 
+    inline std::span<CommandBuffer* const> CommandBuffer::BeginParallelRendering(const BeginRenderingDesc& desc, uint32_t recorder_count) {
+        DnmGLAssert(active_pass == CommandBufferPassType::eNone, 
+        "BeginParallelRendering cannot be call in some pass")
+        DnmGLAssert(!is_recorder, "BeginParallelRendering cannot be call from recorder")
+        DnmGLAssert(!compute_queue, "BeginParallelRendering cannot be call in ExecuteComputeCommands")
+        DnmGLAssert(recorder_count, "recorder_count cannot be 0")
+
+        IsValidBeginRenderingDesc(desc);
+
+        active_graphics_pipeline = desc.pipeline;
+        active_framebuffer = desc.framebuffer;
+        const auto recorders = IBeginParallelRendering(desc, recorder_count);
+        active_recorders = recorders;
+        for (auto* recorder : recorders) {
+            recorder->active_graphics_pipeline = desc.pipeline;
+            recorder->active_framebuffer = desc.framebuffer;
+            recorder->active_pass = CommandBufferPassType::eRendering;
+            recorder->is_recorder = true;
+        }
+        active_pass = CommandBufferPassType::eParallelRendering;
+        return recorders;
+    }
+
     inline void CommandBuffer::BeginComputePass() {
         DnmGLAssert(active_pass == CommandBufferPassType::eNone, 
         "BeginCompute cannot be call in some pass")
@@ -1154,6 +1530,32 @@ namespace DnmGL {
         IBindPipeline(pipeline);
     }
 
+    inline void CommandBuffer::BindUniform(uint32_t binding, const TransientUniform& uniform, uint32_t array_element) {
+        DnmGLAssert(active_pass == CommandBufferPassType::eRendering || active_pass == CommandBufferPassType::eCompute, 
+                    "this function must be call in rendering or compute pass")
+        DnmGLAssert(uniform.buffer, "uniform is not allocated")
+
+        IBindUniform(binding, uniform, array_element);
+    }
+
+    inline void CommandBuffer::PushConstants(const DnmGL::GraphicsPipeline *pipeline, uint32_t offset, std::span<const std::byte> data) {
+        DnmGLAssert(active_pass == CommandBufferPassType::eRendering, "this function must be call in rendering pass")
+        DnmGLAssert(pipeline, "pipeline cannot be null")
+        DnmGLAssert(offset % 4 == 0 && data.size() % 4 == 0, "push constant offset and size must be multiple of 4")
+        if (data.empty()) return;
+
+        IPushConstants(pipeline, offset, data);
+    }
+
+    inline void CommandBuffer::PushConstants(const DnmGL::ComputePipeline *pipeline, uint32_t offset, std::span<const std::byte> data) {
+        DnmGLAssert(active_pass == CommandBufferPassType::eCompute, "this function must be call in compute pass")
+        DnmGLAssert(pipeline, "pipeline cannot be null")
+        DnmGLAssert(offset % 4 == 0 && data.size() % 4 == 0, "push constant offset and size must be multiple of 4")
+        if (data.empty()) return;
+
+        IPushConstants(pipeline, offset, data);
+    }
+
     inline void CommandBuffer::Draw(uint32_t vertex_count, uint32_t instance_count) {
         DnmGLAssert(active_pass == CommandBufferPassType::eRendering, "this function must be call in rendering pass")
 
@@ -1234,6 +1636,43 @@ namespace DnmGL {
         IGenerateMipmaps(image);
     }
 
+    inline ReadbackHandle CommandBuffer::RequestReadback(DnmGL::Buffer *buffer, uint64_t offset, uint64_t size) {
+        DnmGLAssert(active_pass == CommandBufferPassType::eTransfer, "this function must be call in transfer pass")
+        DnmGLAssert(buffer, "buffer cannot be null")
+        DnmGLAssert(size != 0, "size cannot be 0")
+        DnmGLAssert(offset + size <= buffer->GetDesc().GetSize(), "range is out of buffer")
+
+        return IRequestReadback(buffer, offset, size);
+    }
+
+    inline ReadbackHandle CommandBuffer::RequestReadback(DnmGL::Image *image, 
+                                                        const ImageSubresource& subresource, 
+                                                        Uint3 copy_extent, 
+                                                        Uint3 copy_offset) {
+        DnmGLAssert(active_pass == CommandBufferPassType::eTransfer, "this function must be call in transfer pass")
+        DnmGLAssert(image, "image cannot be null")
+        DnmGLAssert(copy_extent.x != 0 && copy_extent.y != 0 && copy_extent.z != 0, "copy_extent cannot be 0")
+
+        const auto& desc = image->GetDesc();
+        const uint32_t mip = subresource.base_mipmap;
+        //z is array count if image is not 3D
+        const uint32_t image_layer_count = desc.type == ImageType::e3D ? 1 : desc.extent.z;
+        const Uint3 mip_extent = {
+            std::max(desc.extent.x >> mip, 1u),
+            std::max(desc.extent.y >> mip, 1u),
+            desc.type == ImageType::e3D ? std::max(desc.extent.z >> mip, 1u) : 1u,
+        };
+        DnmGLAssert(mip < desc.mipmap_levels, "base_mipmap is out of image")
+        DnmGLAssert(subresource.layer_count != 0 && uint32_t(subresource.base_layer) + subresource.layer_count <= image_layer_count, 
+            "layers are out of image")
+        DnmGLAssert(uint64_t(copy_offset.x) + copy_extent.x <= mip_extent.x
+                && uint64_t(copy_offset.y) + copy_extent.y <= mip_extent.y
+                && uint64_t(copy_offset.z) + copy_extent.z <= mip_extent.z, 
+            "copy range is out of mip")
+
+        return IRequestReadback(image, subresource, copy_extent, copy_offset);
+    }
+
     inline void CommandBuffer::BindVertexBuffer(const DnmGL::Buffer *buffer, uint64_t offset) {
         DnmGLAssert(active_pass == CommandBufferPassType::eRendering, "this function must be call in rendering pass")
         DnmGLAssert(buffer, "buffer cannot be null")
@@ -1249,7 +1688,7 @@ namespace DnmGL {
     }
     
     template <typename T> 
-    inline void CommandBuffer::UploadData(DnmGL::Buffer *buffer, std::span<const T> data, uint32_t offset) {
+    inline void CommandBuffer::UploadData(DnmGL::Buffer *buffer, std::span<const T> data, uint64_t offset) {
         DnmGLAssert(active_pass == CommandBufferPassType::eTransfer, "this function must be call in transfer pass")
         DnmGLAssert(buffer, "buffer cannot be null")
         if (data.empty()) return;
@@ -1267,7 +1706,7 @@ namespace DnmGL {
         DnmGLAssert(image, "image cannot be null")
         if (data.empty()) return;
 
-        const auto copy_size = copy_extent.x  *copy_extent.y  *copy_extent.z  *GetFormatSize(image->GetDesc().format);
+        const auto copy_size = uint64_t(copy_extent.x)  *copy_extent.y  *copy_extent.z  *subresource.layer_count  *GetFormatSize(image->GetDesc().format);
         if (data.size()  *sizeof(T) < copy_size) [[unlikely]]
             context->Message(
                 std::format("data size must be equal or bigger than copy_extent pixel count; data.size(): {}, copy_extent pixel count {}",
@@ -1287,22 +1726,38 @@ namespace DnmGL {
         }
     }
 
+    constexpr ImageSubresource Image::GetResidentSubresource(const ImageSubresource& subresource) const noexcept {
+        const uint32_t end_mip = subresource.base_mipmap + subresource.mipmap_level;
+        const auto base_mip = std::min(std::max<uint32_t>(subresource.base_mipmap, m_resident_mip), end_mip - 1);
+
+        auto resident_subresource = subresource;
+        resident_subresource.base_mipmap = static_cast<uint8_t>(base_mip);
+        resident_subresource.mipmap_level = static_cast<uint8_t>(end_mip - base_mip);
+        return resident_subresource;
+    }
+
     inline void Context::Init(const ContextDesc &desc) {
+        //std::nullopt window handle creates headless context (no surface, swapchain and default framebuffer)
+        headless = GetWindowType(desc.window_handle) == WindowType::eNone;
+
         //TODO: make for other os'es
-        if constexpr (_os == OS::eWin) {
-            //TODO: write error massage
+        if (!headless && _os == OS::eWin) {
             DnmGLAssert(GetWindowType(desc.window_handle) == WindowType::eWindows,
-                "");
+                "window handle must be WinWindowHandle or std::nullopt");
             const auto win_handle = std::get<WinWindowHandle>(desc.window_handle);
             DnmGLAssert(win_handle.hInstance, "WinWindowHandle::hInstance cannot nullptr");
             DnmGLAssert(win_handle.hwnd, "WinWindowHandle::hwnd cannot nullptr");
         }
         
-        if (desc.swapchain_settings.depth_buffer_format != ImageFormat::eUndefined)
-            DnmGLAssert(IsDepthFormat(desc.swapchain_settings.depth_buffer_format), 
-                "depth buffer format must be ImageFormat::eD16Norm, ImageFormat::eD32Float");
-        DnmGLAssert(desc.swapchain_settings.window_extent.x && desc.swapchain_settings.window_extent.y, 
-                "extent values must be bigger than zero")
+        //swapchain settings are ignored in headless context
+        if (!headless) {
+            if (desc.swapchain_settings.depth_buffer_format != ImageFormat::eUndefined)
+                DnmGLAssert(IsDepthFormat(desc.swapchain_settings.depth_buffer_format), 
+                    "depth buffer format must be ImageFormat::eD16Norm, ImageFormat::eD32Float");
+            DnmGLAssert(desc.swapchain_settings.window_extent.x && desc.swapchain_settings.window_extent.y, 
+                    "extent values must be bigger than zero")
+        }
+        DnmGLAssert(desc.frames_in_flight, "frames_in_flight must be bigger than zero")
 
         IInit(desc);
     }
@@ -1319,11 +1774,41 @@ namespace DnmGL {
     template <typename T>
     constexpr T *Buffer::GetMappedPtr() const noexcept {
         DnmGLAssert(m_desc.memory_host_access != MemoryHostAccess::eNone, 
-            "MemoryHostAccess::eNone, must be MemoryHostAccess::eWrite or MemoryHostAccess::eReadWrite");
+            "MemoryHostAccess::eNone, must be MemoryHostAccess::eWrite, MemoryHostAccess::eReadWrite, MemoryHostAccess::eDirectWrite or MemoryHostAccess::eCachedRead");
 
         return reinterpret_cast<T *>(m_mapped_ptr);
     }
 
+    template <typename T>
+    inline T *Buffer::Map() {
+        DnmGLAssert(m_desc.memory_host_access != MemoryHostAccess::eNone, 
+            "MemoryHostAccess::eNone, must be MemoryHostAccess::eWrite, MemoryHostAccess::eReadWrite, MemoryHostAccess::eDirectWrite or MemoryHostAccess::eCachedRead");
+
+        return reinterpret_cast<T *>(IMap());
+    }
+
+    inline void Buffer::Unmap() {
+        DnmGLAssert(m_desc.memory_host_access != MemoryHostAccess::eNone, "buffer is not mapped")
+
+        IUnmap();
+    }
+
+    inline void Buffer::FlushRange(uint64_t offset, uint64_t size) {
+        DnmGLAssert(m_desc.memory_host_access != MemoryHostAccess::eNone, "buffer is not host visible")
+        DnmGLAssert(offset + size <= m_desc.GetSize(), "range is out of buffer")
+        if (size == 0) return;
+
+        IFlushRange(offset, size);
+    }
+
+    inline void Buffer::InvalidateRange(uint64_t offset, uint64_t size) {
+        DnmGLAssert(m_desc.memory_host_access != MemoryHostAccess::eNone, "buffer is not host visible")
+        DnmGLAssert(offset + size <= m_desc.GetSize(), "range is out of buffer")
+        if (size == 0) return;
+
+        IInvalidateRange(offset, size);
+    }
+
     constexpr Buffer::Buffer(Context& context, const DnmGL::BufferDesc& desc) noexcept : RHIObject(context), m_desc(desc) {
         if (m_desc.usage_flags.Has(BufferUsageBits::eUniform)) m_desc.element_size = (m_desc.element_size + 255) & ~255;
         if (m_desc.element_size < 4) m_desc.element_size = 4;
@@ -1472,6 +1957,7 @@ namespace DnmGL {
         DnmGLAssert(context == desc.pipeline->context, "pipeline and commandBuffer must be created from the same context")
         if (desc.framebuffer) DnmGLAssert(context == desc.framebuffer->context, 
                                         "framebuffer and commandBuffer must be created from the same context")
+        else DnmGLAssert(!context->IsHeadless(), "headless context has no default framebuffer, framebuffer cannot be null")
 
         if (desc.framebuffer) DnmGLAssert(desc.pipeline->ColorAttachmentCount() == desc.framebuffer->ColorAttachmentCount(), "pipeline and framebuffer must be same color attachment count")
         else DnmGLAssert(desc.pipeline->ColorAttachmentCount() == 1, "if using default framebuffer, pipeline color attachent count must be 1")
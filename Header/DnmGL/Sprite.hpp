@@ -204,7 +204,7 @@ namespace DnmGL {
             m_sprite_buffer = desc.context->CreateBuffer({
                 .element_size = sizeof(SpriteData),
                 .element_count = init_capacity,
-                .memory_host_access = DnmGL::MemoryHostAccess::eWrite,
+                .memory_host_access = DnmGL::MemoryHostAccess::eDirectWrite,
                 .memory_type = DnmGL::MemoryType::eDeviceMemory,
                 .usage_flags = DnmGL::BufferUsageBits::eReadonlyResource,
             });
@@ -286,7 +286,7 @@ namespace DnmGL {
                 {
                     .buffer = m_camera_buffer.get(),
                     .offset = 0,
-                    .size = m_camera_buffer->GetDesc().element_size,
+                    .size = static_cast<uint32_t>(m_camera_buffer->GetDesc().element_size),
                     .binding = 0,
                     .array_element = 0,
                 },
@@ -306,16 +306,18 @@ namespace DnmGL {
             auto new_buffer = GetContext()->CreateBuffer({
                 .element_size = sizeof(SpriteData),
                 .element_count = (GetCapacity() + (reserve_count < GetCapacity() ? GetCapacity() : reserve_count)),
-                .memory_host_access = DnmGL::MemoryHostAccess::eWrite,
-                .memory_type = DnmGL::MemoryType::eHostMemory,
+                .memory_host_access = DnmGL::MemoryHostAccess::eDirectWrite,
+                .memory_type = DnmGL::MemoryType::eDeviceMemory,
                 .usage_flags = DnmGL::BufferUsageBits::eReadonlyResource,
             });
 
-            command_buffer->CopyBufferToBuffer({
-                .src_buffer = m_sprite_buffer.get(),
-                .dst_buffer = new_buffer.get(),
-                .copy_size = GetSpriteCount() * sizeof(SpriteData),
-            });
+            // sprites are copied on host, so writes of this frame are kept even if they are still staged
+            const auto sprite_data = std::span<const SpriteData>(GetSpriteBufferMappedPtr(), GetSpriteCount());
+            std::memcpy(new_buffer->GetMappedPtr<SpriteData>(), sprite_data.data(), sprite_data.size_bytes());
+            new_buffer->FlushRange(0, sprite_data.size_bytes());
+
+            // staged writes reach the buffer at the begin of the next frame, this frame uses the uploaded copy
+            command_buffer->UploadData(new_buffer.get(), sprite_data, 0);
 
             m_sprite_buffer.swap(new_buffer);
 
@@ -367,6 +369,7 @@ namespace DnmGL {
             &sprite_data, 
             sizeof(SpriteData)
         );
+        m_sprite_buffer->FlushRange(sizeof(SpriteData) * GetSpriteCount(), sizeof(SpriteData));
         
         return m_handles.emplace_back(SpriteHandle(m_sprite_count++));
     }
@@ -377,6 +380,7 @@ namespace DnmGL {
             sprite_data.data(), 
             sizeof(SpriteData) * sprite_data.size()
         );
+        m_sprite_buffer->FlushRange(sizeof(SpriteData) * GetSpriteCount(), sprite_data.size_bytes());
 
         m_handles.reserve(sprite_data.size());
 
@@ -405,6 +409,7 @@ namespace DnmGL {
             auto *deleted_sprite = GetSpriteBufferMappedPtr() + handle.GetValue();
 
             memcpy(deleted_sprite, end_ptr, sizeof(SpriteData));
+            m_sprite_buffer->FlushRange(sizeof(SpriteData) * handle.GetValue(), sizeof(SpriteData));
         }
 
         const auto handle_it = m_handles.begin() + handle.GetValue();
@@ -426,6 +431,10 @@ namespace DnmGL {
             &data,
             sizeof(data)
         );
+        const auto member_offset = static_cast<uint64_t>(
+            reinterpret_cast<const std::byte *>(&(sprite_data.*member)) - reinterpret_cast<const std::byte *>(&sprite_data)
+        );
+        m_sprite_buffer->FlushRange(sizeof(SpriteData) * handle.GetValue() + member_offset, sizeof(data));
     }
 
     inline void SpriteManager::SetSprite(DnmGL::SpriteHandle handle, const DnmGL::SpriteData& sprite_data) const noexcept {
@@ -438,6 +447,7 @@ namespace DnmGL {
             &sprite_data,
             sizeof(SpriteData)
         );
+        m_sprite_buffer->FlushRange(sizeof(SpriteData) * handle.GetValue(), sizeof(SpriteData));
     }
 
     inline SpriteData SpriteManager::GetSprite(DnmGL::SpriteHandle handle) const noexcept {
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "DnmGL/DnmGL.hpp"
+
+#include <vector>
+
+namespace DnmGL {
+    //growable array in device memory, elements are kept on host and written to the buffer by Upload
+    //buffer grows geometrically in Upload, old elements are copied on gpu and bound resource managers are updated
+    template <typename T>
+    class GpuVector {
+    public:
+        GpuVector(Context& context, BufferUsageFlags usage_flags, uint32_t capacity = 64);
+
+        GpuVector(const GpuVector&) = delete;
+        GpuVector& operator=(const GpuVector&) = delete;
+        GpuVector(GpuVector&&) noexcept = default;
+        GpuVector& operator=(GpuVector&&) noexcept = default;
+
+        void push_back(const T& value);
+        //last element is moved to index, order is not kept
+        void erase_swap(uint32_t index);
+        void resize(uint32_t size, const T& value = {});
+        void reserve(uint32_t capacity);
+        void clear() noexcept { m_data.clear(); }
+
+        void Set(uint32_t index, const T& value);
+        //for writes through data()
+        void MarkDirty(uint32_t first, uint32_t count);
+
+        [[nodiscard]] const T& operator[](uint32_t index) const noexcept { return m_data[index]; }
+        [[nodiscard]] T *data() noexcept { return m_data.data(); }
+        [[nodiscard]] const T *data() const noexcept { return m_data.data(); }
+        [[nodiscard]] uint32_t size() const noexcept { return static_cast<uint32_t>(m_data.size()); }
+        [[nodiscard]] uint32_t capacity() const noexcept { return m_capacity; }
+        [[nodiscard]] bool empty() const noexcept { return m_data.empty(); }
+
+        //bound as writable resource if usage flags has eWritebleResource, otherwise as readonly resource
+        void Bind(ResourceManager *resource_manager, uint32_t binding, uint32_t array_element = 0);
+        void Unbind(const ResourceManager *resource_manager);
+
+        //grows buffer and uploads dirty elements, call in transfer pass of the command buffer using the buffer
+        void Upload(CommandBuffer *command_buffer);
+
+        //changes when Upload grows the buffer
+        [[nodiscard]] Buffer *GetBuffer() const noexcept { return m_buffer.get(); }
+    private:
+        struct Binding {
+            ResourceManager *resource_manager;
+            uint32_t binding;
+            uint32_t array_element;
+        };
+
+        Buffer::Ptr CreateBuffer(uint32_t capacity) const;
+        void Grow(CommandBuffer *command_buffer);
+        void BindBuffer(const Binding& binding) const;
+
+        Context *m_context;
+        BufferUsageFlags m_usage_flags;
+        Buffer::Ptr m_buffer;
+        std::vector<T> m_data;
+        std::vector<Binding> m_bindings;
+        //buffer is created with this capacity at next Upload if it is bigger than the buffer
+        uint32_t m_capacity;
+        //elements written to the buffer by the last Upload
+        uint32_t m_uploaded_size{};
+        //elements in [dirty_begin, dirty_end) are uploaded by the next Upload
+        uint32_t m_dirty_begin = UINT32_MAX;
+        uint32_t m_dirty_end{};
+    };
+
+    template <typename T>
+    inline GpuVector<T>::GpuVector(Context& context, BufferUsageFlags usage_flags, uint32_t capacity)
+    : m_context(&context), m_usage_flags(usage_flags), m_capacity(std::max(capacity, 1u)) {
+        m_buffer = CreateBuffer(m_capacity);
+        m_data.reserve(m_capacity);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::push_back(const T& value) {
+        reserve(size() + 1);
+        m_data.push_back(value);
+        MarkDirty(size() - 1, 1);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::erase_swap(uint32_t index) {
+        DnmGLAssert(index < size(), "index out of range")
+
+        if (index != size() - 1) {
+            m_data[index] = std::move(m_data.back());
+            MarkDirty(index, 1);
+        }
+        m_data.pop_back();
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::resize(uint32_t size, const T& value) {
+        const auto old_size = this->size();
+        reserve(size);
+        m_data.resize(size, value);
+        if (size > old_size) MarkDirty(old_size, size - old_size);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::reserve(uint32_t capacity) {
+        if (capacity <= m_capacity) return;
+
+        m_capacity = std::max(capacity, m_capacity * 2);
+        m_data.reserve(m_capacity);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::Set(uint32_t index, const T& value) {
+        DnmGLAssert(index < size(), "index out of range")
+
+        m_data[index] = value;
+        MarkDirty(index, 1);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::MarkDirty(uint32_t first, uint32_t count) {
+        m_dirty_begin = std::min(m_dirty_begin, first);
+        m_dirty_end = std::max(m_dirty_end, first + count);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::Bind(ResourceManager *resource_manager, uint32_t binding, uint32_t array_element) {
+        DnmGLAssert(resource_manager, "resource_manager cannot be null")
+
+        const auto& new_binding = m_bindings.emplace_back(resource_manager, binding, array_element);
+        BindBuffer(new_binding);
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::Unbind(const ResourceManager *resource_manager) {
+        std::erase_if(m_bindings, [resource_manager] (const Binding& binding) { return binding.resource_manager == resource_manager; });
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::Upload(CommandBuffer *command_buffer) {
+        DnmGLAssert(command_buffer, "command_buffer cannot be null")
+
+        if (m_capacity > m_buffer->GetDesc().element_count) Grow(command_buffer);
+
+        // erased elements are not uploaded
+        m_dirty_end = std::min(m_dirty_end, size());
+        if (m_dirty_begin < m_dirty_end) {
+            command_buffer->UploadData(
+                m_buffer.get(),
+                std::span<const T>(m_data.data() + m_dirty_begin, m_dirty_end - m_dirty_begin),
+                m_dirty_begin * sizeof(T));
+        }
+
+        m_dirty_begin = UINT32_MAX;
+        m_dirty_end = 0;
+        m_uploaded_size = size();
+    }
+
+    template <typename T>
+    inline Buffer::Ptr GpuVector<T>::CreateBuffer(uint32_t capacity) const {
+        return m_context->CreateBuffer({
+            .element_size = sizeof(T),
+            .element_count = capacity,
+            .memory_host_access = MemoryHostAccess::eNone,
+            .memory_type = MemoryType::eDeviceMemory,
+            .usage_flags = m_usage_flags,
+        });
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::Grow(CommandBuffer *command_buffer) {
+        auto new_buffer = CreateBuffer(m_capacity);
+
+        // recorded in the same command buffer with the upload, so growing needs no extra submission
+        if (m_uploaded_size != 0) {
+            command_buffer->CopyBufferToBuffer({
+                .src_buffer = m_buffer.get(),
+                .dst_buffer = new_buffer.get(),
+                .src_offset = 0,
+                .dst_offset = 0,
+                .copy_size = static_cast<uint64_t>(m_uploaded_size) * sizeof(T),
+            });
+        }
+
+        // vulkan context deletes old buffer after the submission using it is completed
+        m_buffer.swap(new_buffer);
+
+        for (const auto& binding : m_bindings) {
+            BindBuffer(binding);
+        }
+    }
+
+    template <typename T>
+    inline void GpuVector<T>::BindBuffer(const Binding& binding) const {
+        const ResourceDesc resource_desc[] = {
+            {
+                .buffer = m_buffer.get(),
+                .element_count = m_buffer->GetDesc().element_count,
+                .binding = binding.binding,
+                .array_element = binding.array_element,
+            },
+        };
+
+        if (m_usage_flags.Has(BufferUsageBits::eWritebleResource))
+            binding.resource_manager->SetWritableResource(resource_desc);
+        else
+            binding.resource_manager->SetReadonlyResource(resource_desc);
+    }
+}
@@ -6,15 +6,47 @@ namespace DnmGL::Vulkan {
     class Buffer final : public DnmGL::Buffer {
     public:
         Buffer(Vulkan::Context& context, const DnmGL::BufferDesc& desc);
+        // imports host memory, flushed ranges are copied at the begin of next frame if it can't be imported
+        Buffer(Vulkan::Context& context, const DnmGL::BufferDesc& desc, void *host_pointer);
         ~Buffer();
 
+        // queue family indices point to context, valid while context is alive
+        [[nodiscard]] static VkBufferCreateInfo GetCreateInfo(Vulkan::Context& context, const DnmGL::BufferDesc& desc);
+
         [[nodiscard]] auto GetBuffer() const { return m_buffer; }
         [[nodiscard]] auto* GetAllocation() const { return m_allocation; }
+        // MemoryHostAccess::eDirectWrite buffer without host visible memory, mapped pointer points here
+        [[nodiscard]] auto GetStagingBuffer() const { return m_staging_buffer; }
+        [[nodiscard]] auto* GetStagingAllocation() const { return m_staging_allocation; }
+        // host memory that can't be imported, mapped pointer points here
+        [[nodiscard]] auto* GetHostPointer() const { return m_host_pointer; }
+        [[nodiscard]] bool IsHostMemoryImported() const { return bool(m_imported_memory); }
+        // ranges of staged buffer flushed since the last call, sorted and merged, src and dst offsets are same
+        [[nodiscard]] std::vector<vk::BufferCopy> TakeDirtyRanges();
         
         vk::PipelineStageFlags prev_pipeline_stage{};
         vk::AccessFlags prev_access{};
     private:
+        uint8_t *IMap() override;
+        void IUnmap() override;
+        void IFlushRange(uint64_t offset, uint64_t size) override;
+        void IInvalidateRange(uint64_t offset, uint64_t size) override;
+
+        // host writes go to staging allocation if buffer is staged
+        [[nodiscard]] VmaAllocation GetHostAllocation() const { return m_staging_buffer ? m_staging_allocation : m_allocation; }
+
+        void CreateBuffer();
+        void CreateStagingBuffer();
+        bool ImportHostMemory(void *host_pointer);
+
         vk::Buffer m_buffer;
-        VmaAllocation m_allocation;
+        VmaAllocation m_allocation{};
+        vk::Buffer m_staging_buffer{};
+        VmaAllocation m_staging_allocation{};
+        // not allocated by vma, can't be defragmented
+        vk::DeviceMemory m_imported_memory{};
+        void *m_host_pointer{};
+        std::vector<vk::BufferCopy> m_dirty_ranges{};
+        friend Vulkan::Defragmenter;
     };
 }
\ No newline at end of file
@@ -33,10 +33,10 @@ namespace DnmGL::Vulkan {
 
     class CommandBuffer final : public DnmGL::CommandBuffer {
     public:
-        CommandBuffer(Vulkan::Context& context);
+        CommandBuffer(Vulkan::Context& context, vk::CommandPool command_pool, vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary);
         ~CommandBuffer() noexcept {
             VulkanContext
-                ->GetDevice().freeCommandBuffers(VulkanContext->GetCommandPool(), command_buffer);
+                ->GetDevice().freeCommandBuffers(m_command_pool, command_buffer);
         }
     
         void IBegin() override;
@@ -45,6 +45,9 @@ namespace DnmGL::Vulkan {
         void IBeginRendering(const BeginRenderingDesc& desc) override;
         void IEndRendering() override;
 
+        std::span<DnmGL::CommandBuffer* const> IBeginParallelRendering(const BeginRenderingDesc& desc, uint32_t recorder_count) override;
+        void IEndParallelRendering() override;
+
         void IBeginCopyPass() override {}
         void IEndCopyPass() override {
             DeferLayoutTranslation();
@@ -63,8 +66,17 @@ namespace DnmGL::Vulkan {
         void IDispatch(uint32_t x = 1, uint32_t y = 1, uint32_t z = 1) override;
 
         void IBindPipeline(const DnmGL::ComputePipeline* pipeline) override;
+        void IBindUniform(uint32_t binding, const TransientUniform& uniform, uint32_t array_element) override;
+        void IPushConstants(const DnmGL::GraphicsPipeline *pipeline, uint32_t offset, std::span<const std::byte> data) override;
+        void IPushConstants(const DnmGL::ComputePipeline *pipeline, uint32_t offset, std::span<const std::byte> data) override;
 
         void IGenerateMipmaps(DnmGL::Image* image) override;
+
+        ReadbackHandle IRequestReadback(DnmGL::Buffer *buffer, uint64_t offset, uint64_t size) override;
+        ReadbackHandle IRequestReadback(DnmGL::Image *image, 
+                                        const ImageSubresource& subresource, 
+                                        Uint3 copy_extent, 
+                                        Uint3 copy_offset) override;
     
         void IBindVertexBuffer(const DnmGL::Buffer* buffer, uint64_t offset) override;
         void IBindIndexBuffer(const DnmGL::Buffer* buffer, uint64_t offset, DnmGL::IndexType index_type) override;
@@ -80,7 +92,7 @@ namespace DnmGL::Vulkan {
                         const void* data, 
                         Uint3 copy_extent, 
                         Uint3 copy_offset) override;
-        void IUploadData(DnmGL::Buffer *buffer, const void* data, uint32_t size, uint32_t offset) override;
+        void IUploadData(DnmGL::Buffer *buffer, const void* data, uint64_t size, uint64_t offset) override;
 
         void Barrier(std::span<const Vulkan::BufferBarrier> buffer_barriers, std::span<const Vulkan::ImageBarrier> image_barriers) const;
         void BufferBarrier(std::span<const ImageBarrier> desc) const;
@@ -97,18 +109,42 @@ namespace DnmGL::Vulkan {
         void TransferImageLayoutSync2(std::span<const TransferImageLayoutNativeDesc> descs) const;
 
         void DeferLayoutTranslation();
+        // makes transfer writes to readback memory visible to host
+        void HostReadBarrier() const;
+
+        void RecordPushConstants(
+            vk::PipelineLayout pipeline_layout, 
+            const std::optional<vk::PushConstantRange>& range, 
+            uint32_t offset, 
+            std::span<const std::byte> data);
+
+        // recorders are filled from other threads, only primary command buffer marks sets, before recorders are started
+        void MarkSetsUsed(std::span<const vk::DescriptorSet, 4> pipeline_sets, const DnmGL::ResourceManager *resource_manager);
+        void BindDescriptorSets(
+            vk::PipelineBindPoint bind_point, 
+            vk::PipelineLayout pipeline_layout, 
+            std::span<const vk::DescriptorSet, 4> pipeline_sets, 
+            const DnmGL::ResourceManager *resource_manager);
+
 
         void BeginRenderingDefaultVk(const BeginRenderingDesc& desc);
         void BeginRenderingDynamicRendering(const BeginRenderingDesc& desc);
+        void BeginRecorders(
+            const vk::CommandBufferInheritanceInfo& inheritance_info, 
+            vk::PipelineLayout pipeline_layout, 
+            std::span<const vk::DescriptorSet, 4> dst_sets, 
+            const DnmGL::ResourceManager *resource_manager,
+            vk::Pipeline pipeline);
         std::vector<vk::ClearValue> GetClearValues(const BeginRenderingDesc& begin_desc);
 
-        void TranslateAttachmentLayouts(FramebufferBase &framebuffer);
+        void TranslateAttachmentLayouts(FramebufferBase &framebuffer, const AttachmentOps& attachment_ops);
         void TranslateSwapchainImageLayoutsInBegin();
         void TranslateSwapchainImageLayoutsInEnd();
 
         constexpr void BarrierForPipeline(vk::PipelineStageFlags stage_flags, vk::AccessFlags access_flags) noexcept;
 
         vk::CommandBuffer command_buffer;
+        vk::CommandPool m_command_pool;
 
         //procress in BindPipeline or end
         std::unordered_set<Vulkan::Image *> m_pending_layout_restore_images;
@@ -123,6 +159,22 @@ namespace DnmGL::Vulkan {
         vk::PipelineStageFlags prev_stage_flags{};
         vk::AccessFlags prev_access_flags{};
 
+        //bound descriptor sets, uniform set is rebound with new dynamic offsets in BindUniform
+        vk::PipelineBindPoint m_bind_point{};
+        vk::PipelineLayout m_bound_pipeline_layout{};
+        vk::DescriptorSet m_bound_uniform_set{};
+        //null if pipeline has no uniform
+        const Vulkan::ResourceManager *m_bound_resource_manager{};
+        std::vector<uint32_t> m_dynamic_offsets;
+
+        //default framebuffer used in active rendering pass
+        bool m_rendering_to_swapchain{};
+
+        //secondary command buffers of active parallel rendering pass, executed in order
+        std::vector<DnmGL::CommandBuffer *> m_recorders;
+
+        vk::QueueFlags m_queue_flags = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eTransfer;
+
         friend Vulkan::Context;
     };
     
@@ -138,6 +190,8 @@ namespace DnmGL::Vulkan {
     }
     
     inline void CommandBuffer::IBeginRendering(const BeginRenderingDesc& desc) {
+        m_rendering_to_swapchain = !desc.framebuffer;
+
         if (VulkanContext->GetSupportedFeatures().dynamic_rendering)
             BeginRenderingDynamicRendering(desc);
         else
@@ -146,6 +200,14 @@ namespace DnmGL::Vulkan {
         prev_operation = CommandType::ePipeline;
     }
 
+    inline std::span<DnmGL::CommandBuffer* const> CommandBuffer::IBeginParallelRendering(const BeginRenderingDesc& desc, uint32_t recorder_count) {
+        const auto recorders = VulkanContext->GetSecondaryCommandBuffers(recorder_count);
+        m_recorders.assign(recorders.begin(), recorders.end());
+
+        IBeginRendering(desc);
+        return m_recorders;
+    }
+
     inline void CommandBuffer::IDraw(uint32_t vertex_count, uint32_t instance_count) {
         command_buffer.draw(vertex_count, instance_count, 0, 0);
     }
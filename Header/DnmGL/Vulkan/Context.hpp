@@ -17,8 +17,17 @@
     #include <vulkan/vulkan.hpp>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <map>
+#include <unordered_map>
 #include <vector>
+#include <unordered_set>
+#include <set>
+#include <mutex>
+#include <tuple>
+#include <utility>
 #include <cstdint>
 
 #define VMA_VULKAN_VERSION 1001000
@@ -38,6 +47,12 @@ namespace DnmGL::Vulkan {
     class Sampler;
     class FramebufferBase;
     class FramebufferDynamicRendering;
+    class StagingRing;
+    class ReadbackRing;
+    class TransientAttachmentPool;
+    class Defragmenter;
+    class TextureStreamer;
+    class ResourceManager;
 
     // images must be this layout except for copy or transfer commands  
     constexpr vk::ImageLayout GetIdealImageLayout(DnmGL::ImageUsageFlags flags) {
@@ -108,35 +123,6 @@ namespace DnmGL::Vulkan {
             vk::ImageLayout layout;
         };
 
-        struct InternalBufferResource {
-            vk::Buffer buffer;
-            vk::DescriptorType type;
-            uint32_t offset;
-            uint32_t size;
-
-            vk::DescriptorSet set;
-            uint32_t binding;
-            uint32_t array_element;
-        };
-
-        struct InternalImageResource {
-            vk::ImageView image_view;
-            vk::ImageLayout image_layout;
-            vk::DescriptorType type;
-
-            vk::DescriptorSet set;
-            uint32_t binding;
-            uint32_t array_element;
-        };
-
-        struct InternalSamplerResource {
-            vk::Sampler sampler;
-
-            vk::DescriptorSet set;
-            uint32_t binding;
-            uint32_t array_element;
-        };
-
         struct SupportedFeatures {
             bool uniform_buffer_update_after_bind : 1{};
             bool storage_buffer_update_after_bind : 1{};
@@ -149,6 +135,10 @@ namespace DnmGL::Vulkan {
             bool sync2 : 1{};
             bool anisotropy : 1{};
             bool dynamic_rendering : 1{};
+            bool timeline_semaphore : 1{};
+            bool lazily_allocated_memory : 1{};
+            bool host_visible_device_memory : 1{};
+            bool external_memory_host : 1{};
 
             //chatgpt
             operator std::string() {
@@ -163,6 +153,10 @@ namespace DnmGL::Vulkan {
                 s += "sync2: " + std::string(sync2 ? "true" : "false") + "\n";
                 s += "anisotropy: " + std::string(anisotropy ? "true" : "false") + "\n";
                 s += "dynamic_rendering: " + std::string(dynamic_rendering ? "true" : "false") + "\n";
+                s += "timeline_semaphore: " + std::string(timeline_semaphore ? "true" : "false") + "\n";
+                s += "lazily_allocated_memory: " + std::string(lazily_allocated_memory ? "true" : "false") + "\n";
+                s += "host_visible_device_memory: " + std::string(host_visible_device_memory ? "true" : "false") + "\n";
+                s += "external_memory_host: " + std::string(external_memory_host ? "true" : "false") + "\n";
                 s += "\n";
                 return s;
             }
@@ -173,6 +167,47 @@ namespace DnmGL::Vulkan {
             vk::QueueFlags queue_flags;
             uint32_t timestamp_valid_bits;
             uint32_t queue_family;
+            // same with queue_family if device has no transfer only queue
+            uint32_t transfer_queue_family;
+            // same with queue_family if async compute is disabled or device has no compute only queue
+            uint32_t compute_queue_family;
+            // pointer and size of imported host memory must be multiple of it
+            uint64_t min_imported_host_pointer_alignment;
+        };
+
+        // queue of the ticket is stored in the top bits, graphics tickets are frame counts
+        enum class QueueType : uint8_t {
+            eGraphics,
+            eTransfer,
+            eCompute,
+        };
+        static constexpr uint32_t TicketQueueShift = 62;
+        static constexpr uint64_t TicketValueMask = (1ull << TicketQueueShift) - 1;
+
+        // one slot of frames in flight ring
+        struct FrameData {
+            vk::CommandPool command_pool = VK_NULL_HANDLE;
+            CommandBuffer* command_buffer{};
+            vk::Fence fence = VK_NULL_HANDLE;
+            vk::Semaphore acquire_next_image_semaphore = VK_NULL_HANDLE;
+            vk::Semaphore render_finished_semaphore = VK_NULL_HANDLE;
+            // value of frame count after submit, 0 if never submitted
+            uint64_t submitted_frame_count{};
+            // one pool per recorder, so recorders can be filled from different threads
+            std::vector<vk::CommandPool> secondary_command_pools{};
+            std::vector<CommandBuffer*> secondary_command_buffers{};
+        };
+
+        // submission ring of queues except graphics queue
+        struct QueueData {
+            vk::Queue queue = VK_NULL_HANDLE;
+            uint32_t queue_family{};
+            std::vector<FrameData> frames{};
+            uint64_t submit_count{};
+            uint64_t completed_count{};
+            // signaled with submit count, null if timeline semaphore is not supported
+            vk::Semaphore timeline_semaphore = VK_NULL_HANDLE;
+            bool recording{};
         };
     public:
         Context() = default;
@@ -185,12 +220,27 @@ namespace DnmGL::Vulkan {
         void IInit(const ContextDesc&) override;
         void ISetSwapchainSettings(const SwapchainSettings& settings) override;
 
-        void ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func) override;
-        void Render(const std::function<bool(DnmGL::CommandBuffer*)>& func) override;
+        uint64_t ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override;
+        uint64_t Render(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override;
+        uint64_t ExecuteUploadCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override;
+        uint64_t ExecuteComputeCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets = {}) override;
+        bool SavePipelineCache() override;
+        bool SavePipelineManifest() override;
+        void WarmUpPipelines(std::span<DnmGL::GraphicsPipeline* const> pipelines) override;
+        [[nodiscard]] MemoryStats GetMemoryStats() const override;
+        DefragmentationStats Defragment(const DefragmentationDesc& desc = {}) override;
+        using DnmGL::Context::AllocateUniform;
+        TransientUniform AllocateUniform(const void *data, uint32_t size) override;
+        [[nodiscard]] std::span<const std::byte> GetReadbackData(ReadbackHandle handle) override;
+        void ReleaseReadback(ReadbackHandle handle) override;
         void WaitForGPU() override;
+        [[nodiscard]] bool IsComplete(uint64_t ticket) noexcept override;
+        bool Wait(uint64_t ticket, uint64_t timeout = UINT64_MAX) override;
         
         [[nodiscard]] std::unique_ptr<DnmGL::Buffer> CreateBuffer(const DnmGL::BufferDesc&) noexcept override;
+        [[nodiscard]] std::unique_ptr<DnmGL::Buffer> CreateBufferFromHostPointer(const DnmGL::BufferDesc&, void *host_pointer) noexcept override;
         [[nodiscard]] std::unique_ptr<DnmGL::Image> CreateImage(const DnmGL::ImageDesc&) noexcept override;
+        [[nodiscard]] std::unique_ptr<DnmGL::Image> CreateStreamingImage(DnmGL::StreamingImageDesc&&) noexcept override;
         [[nodiscard]] std::unique_ptr<DnmGL::Sampler> CreateSampler(const DnmGL::SamplerDesc&) noexcept override;
         [[nodiscard]] std::unique_ptr<DnmGL::Shader> CreateShader(std::string_view) noexcept override;
         [[nodiscard]] std::unique_ptr<DnmGL::ResourceManager> CreateResourceManager(std::span<const DnmGL::Shader*>) noexcept override;
@@ -203,14 +253,30 @@ namespace DnmGL::Vulkan {
         [[nodiscard]] constexpr auto GetDevice() const noexcept { return m_device; }
         [[nodiscard]] constexpr auto GetPhysicalDevice() const noexcept { return m_physical_device; }
         [[nodiscard]] constexpr auto GetQueue() const noexcept { return m_queue; }
+        [[nodiscard]] constexpr auto GetTransferQueue() const noexcept { return m_transfer.queue; }
+        [[nodiscard]] constexpr auto GetComputeQueue() const noexcept { return m_compute.queue; }
+        // empty if resources are used by one queue family, otherwise resources are created concurrent
+        [[nodiscard]] constexpr std::span<const uint32_t> GetSharedQueueFamilies() const noexcept { return m_shared_queue_families; }
         [[nodiscard]] constexpr auto GetSwapchain() const noexcept { return m_swapchain; }
-        [[nodiscard]] constexpr auto GetCommandPool() const noexcept { return m_command_pool; }
+        [[nodiscard]] constexpr auto GetFramesInFlight() const noexcept { return static_cast<uint32_t>(m_frames.size()); }
+        [[nodiscard]] constexpr auto GetFrameCount() const noexcept { return m_frame_count; }
+        [[nodiscard]] constexpr auto GetFrameIndex() const noexcept { return static_cast<uint32_t>(m_frame_count % m_frames.size()); }
         [[nodiscard]] constexpr auto GetPipelineCache() const noexcept { return m_pipeline_cache; }
         [[nodiscard]] constexpr auto GetDescriptorPool() const noexcept { return m_descriptor_pool; }
         [[nodiscard]] constexpr const auto& GetSwapchainImages() const noexcept { return m_swapchain_images; }
         [[nodiscard]] constexpr const auto& GetSwapchainImageViews() const noexcept { return m_swapchain_image_views; }
-        [[nodiscard]] constexpr auto* GetCommandBuffer() const noexcept { return m_command_buffer; }
+        [[nodiscard]] constexpr auto* GetCommandBuffer() const noexcept { return m_frames[GetFrameIndex()].command_buffer; }
         [[nodiscard]] constexpr auto* GetVmaAllocator() const noexcept { return m_vma_allocator; }
+        // for uploads, reclaimed when the submissions using it are completed
+        [[nodiscard]] constexpr auto& GetStagingRing() noexcept { return *m_staging_ring; }
+        [[nodiscard]] constexpr auto& GetReadbackRing() noexcept { return *m_readback_ring; }
+        [[nodiscard]] constexpr auto& GetTransientAttachmentPool() noexcept { return *m_transient_attachment_pool; }
+        [[nodiscard]] constexpr auto& GetDefragmenter() noexcept { return *m_defragmenter; }
+        [[nodiscard]] constexpr auto& GetTextureStreamer() noexcept { return *m_texture_streamer; }
+        [[nodiscard]] constexpr const auto& GetMemoryPools() const noexcept { return m_memory_pools; }
+        // uniform descriptors point here with GetTransientUniformRange, AllocateUniform results are dynamic offsets
+        [[nodiscard]] constexpr auto* GetTransientUniformBuffer() const noexcept { return m_transient_uniform_buffer; }
+        [[nodiscard]] constexpr auto GetTransientUniformRange() const noexcept { return m_transient_uniform_range; }
         [[nodiscard]] constexpr auto* GetDepthBuffer() const noexcept { return m_depth_buffer; }
         [[nodiscard]] constexpr auto* GetResolveImage() const noexcept { return m_resolve_image; }
         [[nodiscard]] constexpr auto GetSwapchainProperties() const noexcept { return m_swapchain_properties; }
@@ -227,31 +293,133 @@ namespace DnmGL::Vulkan {
         [[nodiscard]]auto GetSupportedFeatures() const { return supported_features; }
         [[nodiscard]]auto GetDeviceFeatures() const { return device_features; }
 
-        void DeleteObject(const std::function<void(vk::Device device, VmaAllocator allocator)>& delete_func) {
-            defer_vulkan_obj_delete.emplace_back(std::move(delete_func));
+        // submission counts of every queue, objects used while recording must outlive the current ones
+        struct SubmissionTag {
+            uint64_t frame_count;
+            uint64_t transfer_count;
+            uint64_t compute_count;
+        };
+        [[nodiscard]] SubmissionTag GetSubmissionTag() const noexcept {
+            return SubmissionTag{
+                m_frame_count + (context_state == ContextState::eCommandBufferRecording),
+                m_transfer.submit_count + m_transfer.recording,
+                m_compute.submit_count + m_compute.recording,
+            };
+        }
+        // completed counts of transfer and compute queues are updated by UpdateCompletedCounts
+        [[nodiscard]] bool IsComplete(const SubmissionTag& tag) const noexcept {
+            return tag.frame_count <= m_completed_frame_count
+                && tag.transfer_count <= m_transfer.completed_count
+                && tag.compute_count <= m_compute.completed_count;
+        }
+        void UpdateCompletedCounts() noexcept {
+            IsComplete(m_transfer, m_transfer.submit_count);
+            IsComplete(m_compute, m_compute.submit_count);
+        }
+
+        // deleted after every submission of every queue that can use the object is completed
+        template <typename T>
+        void DeleteObject(T object) {
+            std::get<DeleteQueue<T>>(m_delete_queues).emplace_back(GetSubmissionTag(), object);
         }
+        void DeleteObject(vk::Buffer buffer, VmaAllocation allocation) { DeleteObject(VmaBuffer{buffer, allocation}); }
+        void DeleteObject(vk::Image image, VmaAllocation allocation) { DeleteObject(VmaImage{image, allocation}); }
+        // allocation is counted in the category until it is destroyed
+        void TrackAllocation(VmaAllocation allocation, MemoryCategory category);
+        void UntrackAllocation(VmaAllocation allocation);
+        // copied from their staging buffers at the begin of every frame
+        void AddStagedBuffer(Vulkan::Buffer *buffer) { m_staged_buffers.insert(buffer); }
+        void RemoveStagedBuffer(Vulkan::Buffer *buffer) { m_staged_buffers.erase(buffer); }
+        // resource managers are rewritten when handles or resident mips of their resources are changed
+        void AddResourceManager(Vulkan::ResourceManager *resource_manager) { m_resource_managers.insert(resource_manager); }
+        void RemoveResourceManager(Vulkan::ResourceManager *resource_manager) { m_resource_managers.erase(resource_manager); }
+        void RewriteResources(const std::unordered_set<const void *>& resources);
+        // sets pool of alloc_create_info or dedicated flag if size is above the threshold of the pool
+        void ApplyMemoryPool(MemoryPoolType type, uint64_t size, const VkBufferCreateInfo& buffer_info, VmaAllocationCreateInfo& alloc_create_info);
+        void ApplyMemoryPool(MemoryPoolType type, uint64_t size, const VkImageCreateInfo& image_info, VmaAllocationCreateInfo& alloc_create_info);
 
         Vulkan::CommandBuffer* GetCommandBufferIfRecording();
-        //just for new created images
-
-        void DeferResourceUpdate(const std::span<const InternalBufferResource>& res);
-        void DeferResourceUpdate(const std::span<const InternalImageResource>& res);
-        void DeferResourceUpdate(const std::span<const InternalSamplerResource>& res);
-
-        void ProcessResource(
-            const Context::InternalBufferResource& res, vk::DescriptorBufferInfo& info, vk::WriteDescriptorSet& write);
-        void ProcessResource(
-            const Context::InternalImageResource& res, vk::DescriptorImageInfo& info, vk::WriteDescriptorSet& write);
-        void ProcessResource(
-            const Context::InternalSamplerResource& res, vk::DescriptorImageInfo& info, vk::WriteDescriptorSet& write);
+        // called when pipeline creates a new attachment op variant, thread safe
+        void RecordPipelineVariant(uint64_t pipeline_key, uint32_t packed_attachment_ops);
+        // secondary command buffers of current frame, created on demand
+        std::span<Vulkan::CommandBuffer* const> GetSecondaryCommandBuffers(uint32_t count);
     private:
-        std::vector<std::function<void(vk::Device device, VmaAllocator allocator)>> defer_vulkan_obj_delete;
+        struct VmaBuffer {
+            vk::Buffer buffer;
+            VmaAllocation allocation;
+        };
+        struct VmaImage {
+            vk::Image image;
+            VmaAllocation allocation;
+        };
+        // capacity is reused, so steady state deletion does not allocate
+        template <typename T>
+        using DeleteQueue = std::vector<std::pair<SubmissionTag, T>>;
+        // destroyed in this order, views before images, aliased images before memory, pipelines before layouts
+        std::tuple<
+            DeleteQueue<vk::Framebuffer>,
+            DeleteQueue<vk::ImageView>,
+            DeleteQueue<VmaImage>,
+            DeleteQueue<vk::Image>,
+            DeleteQueue<VmaAllocation>,
+            DeleteQueue<VmaBuffer>,
+            DeleteQueue<vk::Buffer>,
+            DeleteQueue<vk::DeviceMemory>,
+            DeleteQueue<vk::Pipeline>,
+            DeleteQueue<vk::PipelineLayout>,
+            DeleteQueue<vk::DescriptorSet>,
+            DeleteQueue<vk::DescriptorSetLayout>,
+            DeleteQueue<vk::RenderPass>,
+            DeleteQueue<vk::ShaderModule>,
+            DeleteQueue<vk::Sampler>,
+            DeleteQueue<vk::Semaphore>
+        > m_delete_queues;
+
+        template <typename T>
+        void DeleteVulkanObjects(DeleteQueue<T>& queue);
+        void DestroyObject(VmaBuffer object) { 
+            UntrackAllocation(object.allocation);
+            vmaDestroyBuffer(m_vma_allocator, object.buffer, object.allocation); 
+        }
+        void DestroyObject(VmaImage object) { 
+            UntrackAllocation(object.allocation);
+            vmaDestroyImage(m_vma_allocator, object.image, object.allocation); 
+        }
+        void DestroyObject(VmaAllocation object) { 
+            UntrackAllocation(object);
+            vmaFreeMemory(m_vma_allocator, object); 
+        }
+        void DestroyObject(vk::DeviceMemory object) { m_device.freeMemory(object); }
+        void DestroyObject(vk::DescriptorSet object) { m_device.freeDescriptorSets(m_descriptor_pool, object); }
+        [[nodiscard]] bool IsLazilyAllocated(uint32_t memory_type) const noexcept;
+        template <typename T>
+        void DestroyObject(T object) { m_device.destroy(object); }
 
-        using InternalResource = std::variant<InternalBufferResource, InternalImageResource, InternalSamplerResource>;
-        //just for new created images
-        std::vector<InternalResource> defer_resource_update;
-        void ProcessResourceUpdates();
         void DeleteVulkanObjects();
+        // waits without timeout, false if device is lost
+        bool WaitForFence(vk::Fence fence);
+        void WaitForFrame(FrameData& frame);
+        void EndFrame(FrameData& frame);
+        void ResetCommandPools(FrameData& frame);
+        // streaming image mips and staged direct writes, recorded before user commands
+        void RecordFrameUploads(Vulkan::CommandBuffer& command_buffer);
+        uint64_t Submit(FrameData& frame, std::span<const uint64_t> wait_tickets, bool presenting);
+        // signal_semaphore is used if queue has no timeline semaphore
+        uint64_t Submit(QueueData& queue, FrameData& frame, std::span<const uint64_t> wait_tickets, vk::Semaphore signal_semaphore);
+        void WaitForFrame(QueueData& queue, FrameData& frame);
+        bool IsComplete(QueueData& queue, uint64_t value) noexcept;
+        bool Wait(QueueData& queue, uint64_t value, uint64_t timeout);
+        [[nodiscard]] static constexpr QueueType GetTicketQueue(uint64_t ticket) noexcept { return static_cast<QueueType>(ticket >> TicketQueueShift); }
+        [[nodiscard]] static constexpr uint64_t GetTicketValue(uint64_t ticket) noexcept { return ticket & TicketValueMask; }
+        [[nodiscard]] static constexpr uint64_t MakeTicket(QueueType queue, uint64_t value) noexcept { 
+            return (static_cast<uint64_t>(queue) << TicketQueueShift) | value; 
+        }
+        // cross queue waits, waits on cpu if timeline semaphore is not supported
+        void AddTicketWaits(
+            std::span<const uint64_t> wait_tickets, 
+            std::vector<vk::Semaphore>& wait_semaphores, 
+            std::vector<vk::PipelineStageFlags>& wait_stages, 
+            std::vector<uint64_t>& wait_values);
         void CreateFramebuffers(vk::RenderPass renderpass, std::vector<vk::Framebuffer>& out_framebuffers) noexcept;
 
         struct Dispatcher {
@@ -261,6 +429,8 @@ namespace DnmGL::Vulkan {
             DECLARE_VK_FUNC(vkCmdPipelineBarrier2KHR);
             DECLARE_VK_FUNC(vkCmdBeginRenderingKHR);
             DECLARE_VK_FUNC(vkCmdEndRenderingKHR);
+            DECLARE_VK_FUNC(vkGetSemaphoreCounterValueKHR);
+            DECLARE_VK_FUNC(vkWaitSemaphoresKHR);
         } dispatcher;
 
         SupportedFeatures supported_features;
@@ -269,12 +439,17 @@ namespace DnmGL::Vulkan {
         void CreateInstance(WindowType window_type);
         void CreateDebugMessenger();
         void CreateSurface(const WindowHandle&);
-        void CreateDevice();
-        void CreateCommandPool();
+        void CreateDevice(const ContextDesc& desc);
+        void CreateFrames(uint32_t frames_in_flight);
+        void CreateFrames(QueueData& queue, uint32_t frames_in_flight);
         void CreateDescriptorPool();
         void CreateSwapchain(Uint2 extent, bool Vsync);
         void CreateVmaAllocator();
-        void CreatePipelineCache();
+        // pools are created on first use, a pool has one memory type
+        VmaPool GetOrCreateMemoryPool(MemoryPoolType type, uint32_t memory_type_index);
+        void CreateTransientUniformBuffer(uint32_t size);
+        void CreatePipelineCache(const std::filesystem::path& path);
+        void LoadPipelineManifest(const std::filesystem::path& path);
         void CreateResource();
         void CreateDepthBuffer(Uint2 extent, SampleCount sample_count, ImageFormat format);
         void CreateResolveImage(Uint2 extent, SampleCount sample_count);
@@ -286,36 +461,97 @@ namespace DnmGL::Vulkan {
         vk::Device m_device = VK_NULL_HANDLE;
         vk::Queue m_queue = VK_NULL_HANDLE;
         vk::PipelineCache m_pipeline_cache = VK_NULL_HANDLE;
-        vk::Fence m_fence = VK_NULL_HANDLE;
-        vk::Semaphore m_acquire_next_image_semaphore = VK_NULL_HANDLE;
-        vk::Semaphore m_render_finished_semaphore = VK_NULL_HANDLE;
-        vk::CommandPool m_command_pool = VK_NULL_HANDLE;
-        CommandBuffer* m_command_buffer;
+        std::filesystem::path m_pipeline_cache_path{};
+        // {pipeline key, packed attachment ops}, sorted by pipeline key
+        std::set<std::pair<uint64_t, uint32_t>> m_pipeline_manifest{};
+        std::mutex m_pipeline_manifest_mutex{};
+        std::filesystem::path m_pipeline_manifest_path{};
+        bool m_record_pipeline_manifest{};
+        std::vector<FrameData> m_frames{};
+        // submitted frame count, current frame is m_frames[m_frame_count % m_frames.size()]
+        uint64_t m_frame_count{};
+        uint64_t m_completed_frame_count{};
+        // signaled with frame count on every submit, frame count is the ticket
+        vk::Semaphore m_timeline_semaphore = VK_NULL_HANDLE;
+        QueueData m_transfer{};
+        // transfer submit count waited by graphics queue
+        uint64_t m_transfer_handoff_count{};
+        QueueData m_compute{};
+        std::vector<uint32_t> m_shared_queue_families{};
+        // signaled by uploads if timeline semaphore is not supported, waited by the next graphics submit
+        std::vector<vk::Semaphore> m_pending_handoff_semaphores{};
         vk::SwapchainKHR m_swapchain = VK_NULL_HANDLE;
         std::vector<vk::Image> m_swapchain_images{};
         std::vector<vk::ImageView> m_swapchain_image_views{};
         std::unordered_map<VkRenderPass, std::vector<vk::Framebuffer>> m_framebuffers;
         VmaAllocator m_vma_allocator = VK_NULL_HANDLE;
+        std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::eCount)> m_memory_categories{};
+        uint64_t m_lazily_allocated_bytes{};
+        MemoryPoolSettings m_memory_pool_settings{};
+        // {pool type, memory type index}
+        std::map<std::pair<MemoryPoolType, uint32_t>, VmaPool> m_memory_pools{};
+        std::unique_ptr<Vulkan::StagingRing> m_staging_ring;
+        std::unique_ptr<Vulkan::ReadbackRing> m_readback_ring;
+        std::unique_ptr<Vulkan::TransientAttachmentPool> m_transient_attachment_pool;
+        std::unique_ptr<Vulkan::Defragmenter> m_defragmenter;
+        std::unique_ptr<Vulkan::TextureStreamer> m_texture_streamer;
+        std::unordered_set<Vulkan::ResourceManager *> m_resource_managers{};
+        std::unordered_set<Vulkan::Buffer *> m_staged_buffers{};
+        // every frame in flight has transient_uniform_size bytes, followed by range bytes for the last descriptor
+        Vulkan::Buffer *m_transient_uniform_buffer{};
+        uint32_t m_transient_uniform_size{};
+        uint32_t m_transient_uniform_range{};
+        uint32_t m_transient_uniform_alignment{};
+        // offset in the current frame, can pass the size if memory is exhausted
+        std::atomic<uint64_t> m_transient_uniform_offset{};
         vk::DescriptorPool m_descriptor_pool;
         vk::DescriptorSetLayout m_empty_set_layout;
         vk::DescriptorSet m_empty_set;
         SwapchainProperties m_swapchain_properties;
         SwapchainSettings m_swapchain_settings;
-        Image* m_depth_buffer;
+        Image* m_depth_buffer{};
         //for msaa
-        Image* m_resolve_image;
+        Image* m_resolve_image{};
         uint32_t m_image_index{};
         ContextState context_state = ContextState::eNone;
     };
 
+    inline bool Context::WaitForFence(vk::Fence fence) {
+        if (m_device.waitForFences(fence, vk::True, UINT64_MAX) == vk::Result::eSuccess) return true;
+        Message("waiting for fence failed", MessageType::eDeviceLost);
+        return false;
+    }
+
     inline void Context::WaitForGPU() {
-        if (m_device.getFenceStatus(m_fence) == vk::Result::eSuccess) return;
-        [[maybe_unused]] auto _ = m_device.waitForFences(m_fence, vk::True, 1'000'000'000);
+        // completed counts are advanced only by signaled fences, queues execute in submit order
+        for (auto& frame : m_frames) {
+            WaitForFrame(frame);
+        }
+        for (auto& frame : m_transfer.frames) {
+            WaitForFrame(m_transfer, frame);
+        }
+        for (auto& frame : m_compute.frames) {
+            WaitForFrame(m_compute, frame);
+        }
+    }
+
+    inline void Context::WaitForFrame(FrameData& frame) {
+        if (!WaitForFence(frame.fence)) return;
+        // queue executes in submit order, previous frames completed too
+        m_completed_frame_count = std::max(m_completed_frame_count, frame.submitted_frame_count);
+    }
+
+    inline void Context::WaitForFrame(QueueData& queue, FrameData& frame) {
+        if (!WaitForFence(frame.fence)) return;
+        queue.completed_count = std::max(queue.completed_count, frame.submitted_frame_count);
     }
 
     inline ContextState Context::GetContextState() noexcept {
         if (context_state == ContextState::eCommandExecuting) {
-            if (m_device.getFenceStatus(m_fence) == vk::Result::eSuccess)
+            const bool all_completed = std::ranges::all_of(m_frames, [this] (const FrameData& frame) {
+                return m_device.getFenceStatus(frame.fence) == vk::Result::eSuccess;
+            });
+            if (all_completed)
                 context_state = ContextState::eNone;
         }
         return context_state;
@@ -323,66 +559,29 @@ namespace DnmGL::Vulkan {
 
     inline Vulkan::CommandBuffer* Context::GetCommandBufferIfRecording() {
         if (context_state == ContextState::eCommandBufferRecording) {
-            return m_command_buffer;
+            return GetCommandBuffer();
         }
         return nullptr;
     }
 
-    inline void Context::ProcessResource(const Context::InternalBufferResource& res, vk::DescriptorBufferInfo& info, vk::WriteDescriptorSet& write) {
-        info.setBuffer(res.buffer)
-                .setOffset(res.offset)
-                .setRange(res.size);
-
-        write.setBufferInfo({info})
-                .setDescriptorCount(1)
-                .setDstArrayElement(res.array_element)
-                .setDescriptorType(res.type)
-                .setDstBinding(res.binding)
-                .setDstSet(res.set);
-    }
-
-    inline void Context::ProcessResource(const Context::InternalImageResource& res, vk::DescriptorImageInfo& info, vk::WriteDescriptorSet& write) {
-        info.setImageView(res.image_view)
-            .setImageLayout(res.image_layout)
-            ;
-
-        write.setImageInfo({info})
-                .setDescriptorCount(1)
-                .setDstArrayElement(res.array_element)
-                .setDescriptorType(res.type)
-                .setDstBinding(res.binding)
-                .setDstSet(res.set);
-    }
-
-    inline void Context::ProcessResource(const Context::InternalSamplerResource& res, vk::DescriptorImageInfo& info, vk::WriteDescriptorSet& write) {
-        info.setSampler(res.sampler);
-
-        write.setImageInfo({info})
-            .setDescriptorCount(1)
-            .setDstArrayElement(res.array_element)
-            .setDescriptorType(vk::DescriptorType::eSampler)
-            .setDstBinding(res.binding)
-            .setDstSet(res.set);
-    }
-
-    inline void Context::DeferResourceUpdate(const std::span<const InternalBufferResource>& res) {
-        defer_resource_update.insert(defer_resource_update.end(), res.begin(), res.end());
-    }
+    inline void Context::DeleteVulkanObjects() {
+        UpdateCompletedCounts();
 
-    inline void Context::DeferResourceUpdate(const std::span<const InternalImageResource>& res) {
-        defer_resource_update.insert(defer_resource_update.end(), res.begin(), res.end());
+        std::apply([this] (auto&... queues) { (DeleteVulkanObjects(queues), ...); }, m_delete_queues);
     }
 
-    inline void Context::DeferResourceUpdate(const std::span<const InternalSamplerResource>& res) {
-        defer_resource_update.insert(defer_resource_update.end(), res.begin(), res.end());
-    }
+    template <typename T>
+    inline void Context::DeleteVulkanObjects(DeleteQueue<T>& queue) {
+        // counts are increasing, so completed ones are at the front
+        const auto end_it = std::ranges::find_if(queue, [this] (const auto& obj) {
+            return !IsComplete(obj.first);
+        });
 
-    inline void Context::DeleteVulkanObjects() {
-        for (const auto& delete_func : defer_vulkan_obj_delete) {
-            delete_func(m_device, m_vma_allocator);
+        for (const auto& [_, object] : std::ranges::subrange(queue.begin(), end_it)) {
+            DestroyObject(object);
         }
-        
-        defer_vulkan_obj_delete.clear();
+
+        queue.erase(queue.begin(), end_it);
     }
 
     inline vk::SampleCountFlagBits Context::GetSampleCount(DnmGL::SampleCount sample_count, bool has_stencil) const noexcept {
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "DnmGL/Vulkan/Context.hpp"
+
+#include <unordered_map>
+#include <variant>
+
+namespace DnmGL::Vulkan {
+    // compacts default and custom vma pools one pass at a time without waiting for gpu
+    // copies of a pass are recorded at the end of a frame, moved buffers and images get new handles there
+    // and descriptors of resource managers are rewritten, old memory is released after that frame is completed
+    class Defragmenter {
+    public:
+        Defragmenter(Vulkan::Context& context) : m_context(&context) {}
+        ~Defragmenter();
+
+        Defragmenter(const Defragmenter&) = delete;
+        Defragmenter& operator=(const Defragmenter&) = delete;
+
+        // returns false if a pass is pending or the pass has nothing to copy, moves are prepared otherwise
+        bool BeginPass(const DefragmentationDesc& desc, DefragmentationStats& stats);
+        // called at the end of every frame, copies moves of the prepared pass and swaps their handles
+        void RecordPass(Vulkan::CommandBuffer& command_buffer);
+        // ends the recorded pass if the frame that copied it is completed, returns false while a pass is pending
+        bool EndPass(DefragmentationStats& stats);
+
+        // allocations that are not added are never moved
+        void AddBuffer(VmaAllocation allocation, Vulkan::Buffer *buffer) { m_owners.insert_or_assign(allocation, buffer); }
+        void AddImage(VmaAllocation allocation, Vulkan::Image *image) { m_owners.insert_or_assign(allocation, image); }
+        // returns true if the allocation is moved by the pending pass, the pass frees it instead of the owner
+        bool Remove(VmaAllocation allocation);
+    private:
+        using Owner = std::variant<Vulkan::Buffer*, Vulkan::Image*>;
+        // new handle is bound to dstTmpAllocation, swapped with the old one when the copy is recorded
+        struct Move {
+            Vulkan::Buffer *buffer{};
+            Vulkan::Image *image{};
+            vk::Buffer new_buffer{};
+            vk::Image new_image{};
+            VmaDefragmentationMove *vma_move{};
+        };
+
+        void Begin(const DefragmentationDesc& desc, VmaPool pool);
+        void End(DefragmentationStats& stats);
+        // sets operation to ignore if the allocation cannot be moved
+        void PrepareMove(VmaDefragmentationMove& move);
+        void RecordCopies(vk::CommandBuffer command_buffer);
+        // old handles are deleted after the submissions that can use them
+        void SwapHandles();
+
+        Vulkan::Context *m_context;
+        VmaDefragmentationContext m_defragmentation = VK_NULL_HANDLE;
+        VmaDefragmentationPassMoveInfo m_pass{};
+        // pass is begun and not ended, its copies are recorded once
+        bool m_pass_pending{};
+        bool m_pass_recorded{};
+        // old memory of the recorded pass may be used until this tag is completed
+        Vulkan::Context::SubmissionTag m_pass_tag{};
+        uint64_t m_bytes_moved{};
+        uint32_t m_allocations_moved{};
+        // pools of the current cycle that are not started yet, null is the default pools
+        std::vector<VmaPool> m_pending_pools;
+        std::vector<Move> m_moves;
+        std::unordered_map<VmaAllocation, Owner> m_owners;
+    };
+}
@@ -15,8 +15,16 @@ namespace DnmGL::Vulkan {
         [[nodiscard]] constexpr Vulkan::Image * GetUserDepthStencilAttachment() noexcept { return m_user_depth_stencil_attachment; }
 
         [[nodiscard]] constexpr std::span<const vk::ImageView> GetAttachments() const noexcept { return m_attachments; }
+
+        [[nodiscard]] constexpr std::span<const std::unique_ptr<Vulkan::Image>> GetMsaaColorAttachments() const noexcept { return m_msaa_color_attachments; }
+        // null if user depth stencil attachment is used
+        [[nodiscard]] constexpr Vulkan::Image *GetDepthBuffer() const noexcept { 
+            return m_user_depth_stencil_attachment ? nullptr : m_depth_buffer.get(); 
+        }
     protected:
-        std::unique_ptr<Vulkan::Image> CreateResource(Uint2 extent, ImageUsageFlags usage, DnmGL::ImageFormat format, SampleCount sample_count) noexcept;
+        // slot is the attachment index, attachments used by the same pass must have different slots
+        std::unique_ptr<Vulkan::Image> CreateResource(Uint2 extent, ImageUsageFlags usage, DnmGL::ImageFormat format, SampleCount sample_count, uint32_t slot) noexcept;
+        std::unique_ptr<Vulkan::Image> CreateDepthBuffer() noexcept;
         void SetAttachment(std::span<const DnmGL::RenderAttachment> color_attachments, 
                             DnmGL::RenderAttachment depth_stencil_attachment);
         std::vector<vk::ImageView> m_attachments;
@@ -61,28 +69,18 @@ namespace DnmGL::Vulkan {
     };
 
     inline void FramebufferDefaultVk::DeleteFramebuffers(std::vector<vk::Framebuffer>&& framebuffers) const noexcept {
-        VulkanContext->DeleteObject(
-            [
-                framebuffers = std::move(framebuffers)
-            ] (vk::Device device, [[maybe_unused]] VmaAllocator) noexcept -> void {
-                for (const auto framebuffer : framebuffers) {
-                    device.destroy(framebuffer);
-                }
-            });
+        for (const auto framebuffer : framebuffers) {
+            VulkanContext->DeleteObject(framebuffer);
+        }
     }
     
     inline FramebufferDefaultVk::FramebufferDefaultVk(Vulkan::Context& ctx, const DnmGL::FramebufferDesc& desc) noexcept 
     : Vulkan::FramebufferBase(ctx, desc) {}
     
     inline FramebufferDefaultVk::~FramebufferDefaultVk() noexcept {
-        VulkanContext->DeleteObject(
-            [
-                framebuffers = std::move(m_framebuffers)
-            ] (vk::Device device, [[maybe_unused]] VmaAllocator) noexcept -> void {
-                for (const auto [_, framebuffer] : framebuffers) {
-                    device.destroy(framebuffer);
-                }
-        });
+        for (const auto [_, framebuffer] : m_framebuffers) {
+            VulkanContext->DeleteObject(framebuffer);
+        }
     }
 
     inline vk::Framebuffer FramebufferDefaultVk::GetFramebuffer(vk::RenderPass renderpass) {
@@ -6,13 +6,19 @@
 namespace DnmGL::Vulkan {
     class Image final : public DnmGL::Image {
     public:
-        Image(Vulkan::Context& context, const DnmGL::ImageDesc& desc);
+        // image is bound to alias_allocation if it is not null, used by TransientAttachmentPool
+        Image(Vulkan::Context& context, const DnmGL::ImageDesc& desc, VmaAllocation alias_allocation = VK_NULL_HANDLE);
         ~Image();
 
+        [[nodiscard]] static vk::ImageCreateInfo GetCreateInfo(Vulkan::Context& context, const DnmGL::ImageDesc& desc);
+        [[nodiscard]] static vk::MemoryRequirements GetMemoryRequirements(Vulkan::Context& context, const DnmGL::ImageDesc& desc);
+
         [[nodiscard]] auto GetImage() const { return m_image; }
         [[nodiscard]] auto GetImageLayout() const { return m_image_layout; }
         [[nodiscard]] auto GetAspect() const { return m_aspect; }
         [[nodiscard]] auto *GetAllocation() const { return m_allocation; }
+        // aliased images share memory with other attachments, contents don't outlive a rendering pass
+        [[nodiscard]] bool IsAliased() const { return m_alias_allocation != VK_NULL_HANDLE; }
 
         [[nodiscard]] auto GetIdealImageLayout() const { return Vulkan::GetIdealImageLayout(m_desc.usage_flags); }
         [[nodiscard]] vk::ImageView CreateGetImageView(const ImageSubresource& subresource);
@@ -20,12 +26,18 @@ namespace DnmGL::Vulkan {
         vk::PipelineStageFlags prev_pipeline_stage{};
         vk::AccessFlags prev_access{};
     private:
+        void CreateAliasingImage(const vk::ImageCreateInfo& create_info);
+        void TranslateInitialLayout();
+
         vk::Image m_image;
         vk::ImageLayout m_image_layout = vk::ImageLayout::ePreinitialized;
         vk::ImageAspectFlags m_aspect;
-        VmaAllocation m_allocation;
+        VmaAllocation m_allocation{};
+        VmaAllocation m_alias_allocation{};
 
         std::map<ImageSubresource, vk::ImageView> m_image_views;
         friend Vulkan::CommandBuffer;
+        friend Vulkan::Defragmenter;
+        friend Vulkan::TextureStreamer;
     };
 }
\ No newline at end of file
@@ -13,11 +13,13 @@ namespace DnmGL::Vulkan {
         [[nodiscard]] auto GetPipelineStageFlags() const { return m_pipeline_stage_flags; }
         [[nodiscard]] auto GetAccessFlags() const { return m_access_flags; }
         [[nodiscard]] auto GetSampleCount() const { return m_sample_count; }
+        [[nodiscard]] const auto& GetPushConstantRange() const { return m_push_constant_range; }
     protected:
         vk::Pipeline CreatePipeline(vk::RenderPass renderpass) noexcept;
 
         vk::PipelineLayout m_pipeline_layout;
         vk::DescriptorSet m_dst_sets[4];
+        std::optional<vk::PushConstantRange> m_push_constant_range;
 
         vk::PipelineStageFlags m_pipeline_stage_flags;
         vk::AccessFlags m_access_flags;
@@ -30,6 +32,8 @@ namespace DnmGL::Vulkan {
         ~GraphicsPipelineDefaultVk() noexcept;
 
         std::pair<vk::RenderPass, vk::Pipeline> GetOrCreateAttachmentOpVariant(AttachmentOps attachment_ops, bool presenting);
+        // creates variants recorded in the pipeline manifest
+        void WarmUp(std::span<const uint32_t> packed_variants);
         vk::RenderPass GetRenderpass(uint32_t attachment_ops) noexcept;
         vk::Pipeline GetPipeline(vk::RenderPass render_pass) noexcept;
 
@@ -37,8 +41,11 @@ namespace DnmGL::Vulkan {
         [[nodiscard]] std::span<const vk::DescriptorSet, 4> GetDstSets() const { return m_dst_sets; }
         [[nodiscard]] auto GetPipelineStageFlags() const { return m_pipeline_stage_flags; }
         [[nodiscard]] auto GetAccessFlags() const { return m_access_flags; }
+        // identifies pipeline in the pipeline manifest
+        [[nodiscard]] auto GetManifestKey() const { return m_manifest_key; }
     private:
         vk::RenderPass CreateRenderpass(AttachmentOps renderpass_desc, bool presenting) noexcept;
+        uint64_t m_manifest_key;
         //for renderpass
         std::unordered_map<VkRenderPass, vk::Pipeline> m_pipelines;
         std::unordered_map<uint32_t, vk::RenderPass> m_renderpasses;
@@ -70,8 +77,10 @@ namespace DnmGL::Vulkan {
 
         [[nodiscard]] auto GetPipelineStageFlags() const { return m_pipeline_stage_flags; }
         [[nodiscard]] auto GetAccessFlags() const { return m_access_flags; }
+        [[nodiscard]] const auto& GetPushConstantRange() const { return m_push_constant_range; }
     private:
         vk::DescriptorSet m_dst_sets[4];
+        std::optional<vk::PushConstantRange> m_push_constant_range;
 
         vk::PipelineStageFlags m_pipeline_stage_flags;
         vk::AccessFlags m_access_flags;
@@ -81,41 +90,22 @@ namespace DnmGL::Vulkan {
     };
 
     inline ComputePipeline::~ComputePipeline() noexcept {
-        VulkanContext->DeleteObject(
-            [
-                pipeline = m_pipeline, 
-                pipeline_layout = m_pipeline_layout
-            ] (vk::Device device, [[maybe_unused]] VmaAllocator) noexcept -> void {
-                device.destroy(pipeline_layout);
-                device.destroy(pipeline);
-            });
+        VulkanContext->DeleteObject(m_pipeline);
+        VulkanContext->DeleteObject(m_pipeline_layout);
     }
 
     inline GraphicsPipelineDynamicRendering::~GraphicsPipelineDynamicRendering() noexcept {
-        VulkanContext->DeleteObject(
-            [
-                pipeline = m_pipeline, 
-                pipeline_layout = m_pipeline_layout
-            ] (vk::Device device, [[maybe_unused]] VmaAllocator) noexcept -> void {
-                device.destroy(pipeline_layout);
-                device.destroy(pipeline);
-            });
+        VulkanContext->DeleteObject(m_pipeline);
+        VulkanContext->DeleteObject(m_pipeline_layout);
     }
 
     inline GraphicsPipelineDefaultVk::~GraphicsPipelineDefaultVk() noexcept {
-        VulkanContext->DeleteObject(
-            [
-                pipelines = m_pipelines, 
-                pipeline_layout = m_pipeline_layout,
-                renderpasses = m_renderpasses
-            ] (vk::Device device, [[maybe_unused]] VmaAllocator) noexcept -> void {
-                for (const auto [_, pipeline] : pipelines) {
-                    device.destroy(pipeline);
-                }
-                for (const auto [_, renderpass] : renderpasses) {
-                    device.destroy(renderpass);
-                }
-                device.destroy(pipeline_layout);
-            });
+        for (const auto [_, pipeline] : m_pipelines) {
+            VulkanContext->DeleteObject(pipeline);
+        }
+        for (const auto [_, renderpass] : m_renderpasses) {
+            VulkanContext->DeleteObject(renderpass);
+        }
+        VulkanContext->DeleteObject(m_pipeline_layout);
     }
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "DnmGL/Vulkan/RingBuffer.hpp"
+
+#include <deque>
+#include <unordered_map>
+
+namespace DnmGL::Vulkan {
+    // persistent mapped download buffer, sub-allocated linearly with wrap around
+    // regions are reclaimed in order when they are released and their submissions are completed
+    class ReadbackRing {
+    public:
+        struct Allocation {
+            vk::Buffer buffer;
+            uint64_t offset;
+            ReadbackHandle handle;
+        };
+
+        ReadbackRing(Vulkan::Context& context, uint64_t capacity);
+
+        ReadbackRing(const ReadbackRing&) = delete;
+        ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+        // reserves memory for a copy of the recording submission, grows if there is no free space
+        Allocation Allocate(uint64_t size, uint64_t alignment);
+        // empty until the submission is completed
+        std::span<const std::byte> GetData(ReadbackHandle handle);
+        void Release(ReadbackHandle handle);
+
+        [[nodiscard]] auto GetCapacity() const noexcept { return m_blocks.back()->ring->GetCapacity(); }
+        // max bytes not released at the same time
+        [[nodiscard]] constexpr auto GetHighWaterMark() const noexcept { return m_high_water_mark; }
+    private:
+        struct Block {
+            std::unique_ptr<RingBuffer> ring;
+            // ids of readbacks in allocation order
+            std::deque<uint64_t> readbacks;
+        };
+
+        struct Readback {
+            Block *block;
+            Vulkan::Context::SubmissionTag tag;
+            uint64_t offset;
+            uint64_t size;
+            bool released;
+            // memory is invalidated once when submission is completed
+            bool ready;
+        };
+
+        void Reclaim(Block& block);
+        // deletes previous blocks whose readbacks are released and completed
+        void DeleteUnusedBlocks();
+        bool IsComplete(const Vulkan::Context::SubmissionTag& tag);
+        std::unique_ptr<Block> CreateBlock(uint64_t capacity);
+
+        Vulkan::Context *m_context;
+        // allocations are made from the last block, previous blocks are deleted when their readbacks are reclaimed
+        std::vector<std::unique_ptr<Block>> m_blocks;
+        std::unordered_map<uint64_t, Readback> m_readbacks;
+        uint64_t m_next_id = 1;
+        // bytes of readbacks that are not released
+        uint64_t m_used{};
+        uint64_t m_high_water_mark{};
+    };
+}
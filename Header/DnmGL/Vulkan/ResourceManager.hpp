@@ -3,6 +3,9 @@
 #include "DnmGL/Vulkan/Context.hpp"
 #include "DnmGL/Vulkan/Shader.hpp"
 
+#include <map>
+#include <unordered_set>
+
 namespace DnmGL::Vulkan {
     class ResourceManager final : public DnmGL::ResourceManager {
     public:
@@ -29,22 +32,56 @@ namespace DnmGL::Vulkan {
         [[nodiscard]] vk::DescriptorSet GetSamplerSet() const noexcept { return m_dst_sets[3]; }
         [[nodiscard]] vk::DescriptorSetLayout GetSamplerSetLayout() const noexcept { return m_dst_set_layouts[3]; }
 
+        // sets other than the empty set are replaced by current sets at bind time, see GetBindSets
         void FillDescriptorSets(std::span<vk::DescriptorSet, 4> sets, std::span<const EntryPointInfo *> entry_points) const noexcept;
+        // current sets for the sets filled by FillDescriptorSets
+        [[nodiscard]] std::array<vk::DescriptorSet, 4> GetBindSets(std::span<const vk::DescriptorSet, 4> pipeline_sets) const noexcept;
+        // marks sets as used by the recording submission, called only by primary command buffers
+        // recorders bind the sets bound by their primary command buffer, so they don't mark them
+        void MarkSetsUsed(std::span<const vk::DescriptorSet, 4> pipeline_sets) const noexcept;
         void FillDescriptorSetLayouts(std::span<vk::DescriptorSetLayout, 4> layouts, std::span<const EntryPointInfo *> entry_points) const noexcept;
+
+        // uniform buffers are dynamic, one offset per array element ordered by binding
+        [[nodiscard]] uint32_t GetDynamicOffsetCount() const noexcept { return m_dynamic_offset_count; }
+        [[nodiscard]] std::optional<uint32_t> GetDynamicOffsetIndex(uint32_t binding, uint32_t array_element) const noexcept;
+
+        // writes descriptors of buffers and images again, after their handles or resident mips are changed
+        void RewriteResources(const std::unordered_set<const void *>& moved_resources);
     private:
+        // sets used by recorded or executing commands are not written, a copy replaces the set and is written instead
+        vk::DescriptorSet GetSetForWrite(uint32_t set_index);
+
         std::array<vk::DescriptorSet, 4> m_dst_sets;
+        // last submission binding the set, replaced sets are deleted after it
+        mutable std::array<Context::SubmissionTag, 4> m_set_use_tags{};
         std::array<vk::DescriptorSetLayout, 4> m_dst_set_layouts;
+        // binding, first dynamic offset index
+        std::vector<std::pair<uint32_t, uint32_t>> m_dynamic_offset_indices;
+        uint32_t m_dynamic_offset_count{};
+        // {binding, array element}, resources written by Set*Resource
+        std::map<std::pair<uint32_t, uint32_t>, ResourceDesc> m_readonly_resources;
+        std::map<std::pair<uint32_t, uint32_t>, ResourceDesc> m_writable_resources;
+        std::map<std::pair<uint32_t, uint32_t>, UniformResourceDesc> m_uniform_resources;
     };
 
     inline ResourceManager::~ResourceManager() {
-        VulkanContext->DeleteObject(
-            [
-                layouts = m_dst_set_layouts
-            ] (vk::Device device, [[maybe_unused]] VmaAllocator) -> void {
-                for (const auto layout : layouts) {
-                    device.destroy(layout);
-                }
-            });
+        VulkanContext->RemoveResourceManager(this);
+        for (const auto set : m_dst_sets) {
+            VulkanContext->DeleteObject(set);
+        }
+        for (const auto layout : m_dst_set_layouts) {
+            VulkanContext->DeleteObject(layout);
+        }
+    }
+
+    inline std::optional<uint32_t> ResourceManager::GetDynamicOffsetIndex(uint32_t binding, uint32_t array_element) const noexcept {
+        const auto it = std::ranges::find(m_dynamic_offset_indices, binding, &std::pair<uint32_t, uint32_t>::first);
+        if (it == m_dynamic_offset_indices.end()) return std::nullopt;
+
+        const auto *binding_info = GetUniformResourcesBinding(binding);
+        if (array_element >= binding_info->resource_count) return std::nullopt;
+
+        return it->second + array_element;
     }
 
     inline void ResourceManager::FillDescriptorSets(std::span<vk::DescriptorSet, 4> sets, std::span<const EntryPointInfo *> entry_points) const noexcept {
@@ -68,6 +105,25 @@ namespace DnmGL::Vulkan {
         sets[3] = has_sampler_res ? GetSamplerSet() : empty_set;
     }
 
+    inline std::array<vk::DescriptorSet, 4> ResourceManager::GetBindSets(std::span<const vk::DescriptorSet, 4> pipeline_sets) const noexcept {
+        const auto empty_set = VulkanContext->GetEmptySet();
+
+        std::array<vk::DescriptorSet, 4> sets;
+        for (const auto i : Counter(4)) {
+            sets[i] = pipeline_sets[i] == empty_set ? empty_set : m_dst_sets[i];
+        }
+        return sets;
+    }
+
+    inline void ResourceManager::MarkSetsUsed(std::span<const vk::DescriptorSet, 4> pipeline_sets) const noexcept {
+        const auto empty_set = VulkanContext->GetEmptySet();
+        const auto submission_tag = VulkanContext->GetSubmissionTag();
+
+        for (const auto i : Counter(4)) {
+            if (pipeline_sets[i] != empty_set) m_set_use_tags[i] = submission_tag;
+        }
+    }
+
     inline void ResourceManager::FillDescriptorSetLayouts(std::span<vk::DescriptorSetLayout, 4> layouts, std::span<const EntryPointInfo *> entry_points) const noexcept {
         const auto empty_set = VulkanContext->GetEmptySetLayout();
 
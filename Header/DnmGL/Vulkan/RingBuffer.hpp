@@ -0,0 +1,52 @@
+#pragma once
+
+#include "DnmGL/Vulkan/Context.hpp"
+
+namespace DnmGL::Vulkan {
+    // persistent mapped buffer shared by every queue family, sub-allocated linearly with wrap around
+    // owner frees regions in allocation order, used by staging and readback rings
+    class RingBuffer {
+    public:
+        // host_access_flags are VMA_ALLOCATION_CREATE_HOST_ACCESS_* bits, name is used in messages
+        RingBuffer(Vulkan::Context& context, uint64_t capacity, vk::BufferUsageFlags usage, VmaAllocationCreateFlags host_access_flags, std::string_view name);
+        ~RingBuffer();
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        // returns offset of the region, null if there is no contiguous free space
+        std::optional<uint64_t> Allocate(uint64_t size, uint64_t alignment);
+        // regions before end are free
+        void Free(uint64_t end) noexcept { m_tail = end; }
+        // every region is free
+        void Clear() noexcept;
+
+        [[nodiscard]] constexpr auto GetBuffer() const noexcept { return m_buffer; }
+        [[nodiscard]] constexpr auto GetAllocation() const noexcept { return m_allocation; }
+        [[nodiscard]] constexpr auto *GetMappedPtr() const noexcept { return m_mapped_ptr; }
+        [[nodiscard]] constexpr auto GetCapacity() const noexcept { return m_capacity; }
+        [[nodiscard]] constexpr uint64_t GetUsedBytes() const noexcept;
+    private:
+        Vulkan::Context *m_context;
+        vk::Buffer m_buffer{};
+        VmaAllocation m_allocation{};
+        std::byte *m_mapped_ptr{};
+        uint64_t m_capacity{};
+        // next allocation starts at head, oldest used region starts at tail
+        uint64_t m_head{};
+        uint64_t m_tail{};
+        // head == tail is full if not empty
+        bool m_empty = true;
+    };
+
+    inline void RingBuffer::Clear() noexcept {
+        m_head = 0;
+        m_tail = 0;
+        m_empty = true;
+    }
+
+    constexpr uint64_t RingBuffer::GetUsedBytes() const noexcept {
+        if (m_empty) return 0;
+        return m_head > m_tail ? m_head - m_tail : m_capacity - m_tail + m_head;
+    }
+}
@@ -7,11 +7,7 @@ namespace DnmGL::Vulkan {
     public:
         Sampler(DnmGL::Vulkan::Context& context, const DnmGL::SamplerDesc& desc);
         ~Sampler() {
-            const auto sampler = m_sampler;
-            VulkanContext->DeleteObject(
-                [sampler] (vk::Device device, [[maybe_unused]] VmaAllocator) -> void {
-                    device.destroy(sampler);
-                });
+            VulkanContext->DeleteObject(m_sampler);
         }
 
         [[nodiscard]] vk::Sampler GetSampler() const { return m_sampler; }
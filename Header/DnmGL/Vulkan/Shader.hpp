@@ -7,11 +7,7 @@ namespace DnmGL::Vulkan {
     public:
         Shader(Vulkan::Context& context, std::string_view filename);
         ~Shader() {
-            const auto shader_module = m_shader_module;
-            VulkanContext->DeleteObject(
-                [shader_module] (vk::Device device, [[maybe_unused]] VmaAllocator allocator) -> void {
-                    device.destroy(shader_module);
-                });
+            VulkanContext->DeleteObject(m_shader_module);
         }
 
         [[nodiscard]] vk::ShaderModule GetShaderModule() const { return m_shader_module; }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "DnmGL/Vulkan/RingBuffer.hpp"
+
+#include <deque>
+
+namespace DnmGL::Vulkan {
+    // persistent mapped upload buffer, sub-allocated linearly with wrap around
+    // regions are reclaimed when the submissions recording while they are allocated are completed
+    class StagingRing {
+    public:
+        struct Allocation {
+            vk::Buffer buffer;
+            uint64_t offset;
+        };
+
+        StagingRing(Vulkan::Context& context, uint64_t capacity);
+
+        StagingRing(const StagingRing&) = delete;
+        StagingRing& operator=(const StagingRing&) = delete;
+
+        // copies data into the ring, grows if there is no free space
+        Allocation Write(const void *data, uint64_t size, uint64_t alignment);
+
+        [[nodiscard]] auto GetCapacity() const noexcept { return m_ring->GetCapacity(); }
+        // max bytes in use at the same time
+        [[nodiscard]] constexpr auto GetHighWaterMark() const noexcept { return m_high_water_mark; }
+    private:
+        struct Region {
+            Vulkan::Context::SubmissionTag tag;
+            // offset of the end of the region
+            uint64_t end;
+        };
+
+        void Reclaim();
+        std::unique_ptr<RingBuffer> CreateRing(uint64_t capacity);
+
+        Vulkan::Context *m_context;
+        std::unique_ptr<RingBuffer> m_ring;
+        uint64_t m_high_water_mark{};
+        std::deque<Region> m_regions;
+    };
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "DnmGL/Vulkan/Context.hpp"
+
+namespace DnmGL::Vulkan {
+    // uploads mips of streaming images at the begin of frames, smallest pending mips first
+    // resident mips and descriptors of images are updated by Commit, after the upload is submitted
+    class TextureStreamer {
+    public:
+        TextureStreamer(Vulkan::Context& context, uint64_t budget) : m_context(&context), m_budget(budget) {}
+
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        // nothing of the image is resident until the first upload, returns false if mip data is too small
+        bool Add(Vulkan::Image *image, std::vector<std::vector<std::byte>>&& mip_data);
+        void Remove(Vulkan::Image *image) { std::erase_if(m_entries, [image] (const Entry& entry) { return entry.image == image; }); }
+
+        // records uploads within budget, returns true if something is recorded
+        // uploads that are recorded but not committed are recorded again
+        bool Update(Vulkan::CommandBuffer& command_buffer);
+        // call after the command buffer of the last Update is submitted
+        void Commit();
+
+        [[nodiscard]] constexpr bool IsIdle() const noexcept { return m_entries.empty(); }
+    private:
+        struct Entry {
+            Vulkan::Image *image;
+            // freed after upload is committed
+            std::vector<std::vector<std::byte>> mip_data;
+            // smallest mip recorded by the last Update, resident after Commit
+            uint32_t recorded_mip;
+        };
+
+        void Upload(Vulkan::CommandBuffer& command_buffer, Entry& entry, uint32_t mip);
+
+        Vulkan::Context *m_context;
+        uint64_t m_budget;
+        std::vector<Entry> m_entries;
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "DnmGL/Vulkan/Context.hpp"
+#include "DnmGL/Vulkan/Image.hpp"
+
+#include <map>
+
+namespace DnmGL::Vulkan {
+    // lends msaa attachments of framebuffers, their contents are kept until another image writes the memory
+    // attachments with the same format, extent, sample count, usage and slot alias one memory allocation
+    // slot is the attachment index in the framebuffer, so attachments of the same pass never alias
+    class TransientAttachmentPool {
+    public:
+        TransientAttachmentPool(Vulkan::Context& context) : m_context(&context) {}
+        ~TransientAttachmentPool();
+
+        TransientAttachmentPool(const TransientAttachmentPool&) = delete;
+        TransientAttachmentPool& operator=(const TransientAttachmentPool&) = delete;
+
+        std::unique_ptr<Vulkan::Image> Acquire(Uint2 extent, ImageUsageFlags usage, DnmGL::ImageFormat format, SampleCount sample_count, uint32_t slot);
+        // called by aliased images at destruction, memory is deleted with the last image
+        void Release(VmaAllocation allocation, const Vulkan::Image *image);
+        // image becomes the last writer of the memory, returns true if another image wrote it after the image
+        [[nodiscard]] bool MarkWritten(VmaAllocation allocation, const Vulkan::Image *image);
+
+        // bytes that would be allocated additionally without aliasing
+        [[nodiscard]] constexpr auto GetAliasedBytes() const noexcept { return m_aliased_bytes; }
+    private:
+        // format, width, height, sample count, usage, slot
+        using Key = std::tuple<DnmGL::ImageFormat, uint32_t, uint32_t, SampleCount, uint8_t, uint32_t>;
+        struct Entry {
+            VmaAllocation allocation;
+            uint64_t size;
+            uint32_t ref_count;
+            // null if the memory is not written yet or the last writer is destroyed
+            const Vulkan::Image *last_writer;
+        };
+
+        VmaAllocation Allocate(const vk::MemoryRequirements& requirements);
+
+        Vulkan::Context *m_context;
+        std::map<Key, Entry> m_entries;
+        uint64_t m_aliased_bytes{};
+    };
+}
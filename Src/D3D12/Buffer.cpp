@@ -17,7 +17,7 @@ namespace DnmGL::D3D12 {
         D3D12_RESOURCE_DESC resourceDesc = {};
         resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
         resourceDesc.Alignment = 0;
-        resourceDesc.Width = m_desc.element_count * m_desc.element_size;
+        resourceDesc.Width = m_desc.GetSize();
         resourceDesc.Height = 1;
         resourceDesc.DepthOrArraySize = 1;
         resourceDesc.MipLevels = 1;
@@ -30,7 +30,15 @@ namespace DnmGL::D3D12 {
         D3D12MA::ALLOCATION_DESC allocationDesc = {};
         allocationDesc.HeapType = D3D12_HEAP_TYPE_DEFAULT;
 
-        if (m_desc.memory_type == MemoryType::eHostMemory) {
+        if (m_desc.memory_host_access == MemoryHostAccess::eDirectWrite) {
+            allocationDesc.HeapType = D3D12Context->GetDeviceFeatures().gpu_upload_heap 
+                                    ? D3D12_HEAP_TYPE_GPU_UPLOAD 
+                                    : D3D12_HEAP_TYPE_UPLOAD;
+        }
+        else if (m_desc.memory_host_access == MemoryHostAccess::eCachedRead) {
+            allocationDesc.HeapType = D3D12_HEAP_TYPE_READBACK;
+        }
+        else if (m_desc.memory_type == MemoryType::eHostMemory) {
             if (m_desc.memory_host_access == MemoryHostAccess::eReadWrite) {
                 allocationDesc.HeapType = D3D12_HEAP_TYPE_READBACK;
             }
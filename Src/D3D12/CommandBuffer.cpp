@@ -34,6 +34,11 @@ namespace DnmGL::D3D12 {
         }
     }
 
+    // buffer views have 32 bit sizes, buffers bigger than 4GiB are clamped to their first 4GiB
+    static constexpr UINT GetViewSize(const DnmGL::Buffer *buffer) noexcept {
+        return static_cast<UINT>(std::min<uint64_t>(buffer->GetDesc().GetSize(), UINT32_MAX));
+    }
+
     CommandBuffer::CommandBuffer(D3D12::Context& ctx)
         : DnmGL::CommandBuffer(ctx) {
         D3D12Context->GetDevice()->CreateCommandList(
@@ -327,7 +332,8 @@ namespace DnmGL::D3D12 {
                         Uint3 copy_extent, 
                         Uint3 copy_offset) {
 
-        const auto copy_size = copy_extent.x * copy_extent.y * copy_extent.z * GetFormatSize(image->GetDesc().format);
+        // one subresource is copied, layer_count is not used
+        const auto copy_size = uint64_t(copy_extent.x) * copy_extent.y * copy_extent.z * GetFormatSize(image->GetDesc().format);
 
         auto *typed_image = static_cast<D3D12::Image *>(image);
         auto *dst_resource = typed_image->GetResource();
@@ -404,7 +410,7 @@ namespace DnmGL::D3D12 {
             &src, &box);
     }
 
-    void CommandBuffer::IUploadData(DnmGL::Buffer *buffer, const void* data, uint32_t size, uint32_t offset) {
+    void CommandBuffer::IUploadData(DnmGL::Buffer *buffer, const void* data, uint64_t size, uint64_t offset) {
         auto *typed_buffer = static_cast<D3D12::Buffer *>(buffer);
 
         D3D12::Buffer staging_buffer(*D3D12Context, {
@@ -482,8 +488,8 @@ namespace DnmGL::D3D12 {
     void CommandBuffer::IBindVertexBuffer(const DnmGL::Buffer *buffer, uint64_t offset) {
         const D3D12_VERTEX_BUFFER_VIEW vbv{
             static_cast<const D3D12::Buffer *>(buffer)->GetResource()->GetGPUVirtualAddress(),
-            buffer->GetDesc().element_size * buffer->GetDesc().element_count,
-            buffer->GetDesc().element_size,
+            GetViewSize(buffer),
+            static_cast<UINT>(buffer->GetDesc().element_size),
         };
         m_command_list->IASetVertexBuffers(
             offset, 
@@ -494,7 +500,7 @@ namespace DnmGL::D3D12 {
     void CommandBuffer::IBindIndexBuffer(const DnmGL::Buffer *buffer, uint64_t offset, DnmGL::IndexType index_type) {
         const D3D12_INDEX_BUFFER_VIEW ibv{
             static_cast<const D3D12::Buffer *>(buffer)->GetResource()->GetGPUVirtualAddress(),
-            buffer->GetDesc().element_size * buffer->GetDesc().element_count,
+            GetViewSize(buffer),
             index_type == IndexType::eUint16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT
         };
         m_command_list->IASetIndexBuffer(
@@ -9,33 +9,66 @@
 #include "DnmGL/D3D12/Framebuffer.hpp"
 #include "DnmGL/D3D12/ToDxgiFormat.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 namespace DnmGL::D3D12 {
-    static void GetHardwareAdapter(IDXGIFactory6* factory, IDXGIAdapter1** out_adapter) {
+    // luid in first 8 bytes, rest is zero, same layout as AdapterProperties::uuid
+    static std::array<uint8_t, 16> GetAdapterUuid(const DXGI_ADAPTER_DESC1& desc) noexcept {
+        std::array<uint8_t, 16> uuid{};
+        std::memcpy(uuid.data(), &desc.AdapterLuid, sizeof(LUID));
+        return uuid;
+    }
+
+    // adapters are enumerated in high performance order, so first suitable one is the best
+    static uint32_t GetHardwareAdapter(IDXGIFactory6* factory, IDXGIAdapter1** out_adapter, const ContextDesc& context_desc, bool use_override) {
         *out_adapter = nullptr;
         ComPtr<IDXGIAdapter1> adapter;
 
-        uint32_t adapter_index = 0;
-        while (true) {
+        for (uint32_t adapter_index = 0;
             SUCCEEDED(factory->EnumAdapterByGpuPreference(
-                adapter_index++,
+                adapter_index,
                 DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE,
                 IID_PPV_ARGS(&adapter)));
+            ++adapter_index) {
 
             DXGI_ADAPTER_DESC1 desc;
             adapter->GetDesc1(&desc);
 
-            if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) {
+            // explicitly requested adapter can be software
+            if (use_override && context_desc.adapter_uuid) {
+                if (GetAdapterUuid(desc) != *context_desc.adapter_uuid) 
+                    continue;
+            }
+            else if (use_override && context_desc.adapter_index) {
+                if (adapter_index != *context_desc.adapter_index) 
+                    continue;
+            }
+            else if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) {
                 continue;
             }
 
             if (SUCCEEDED(D3D12CreateDevice(
                 adapter.Get(), 
                 D3D_FEATURE_LEVEL_12_0, _uuidof(ID3D12Device), nullptr))) {
-                break;
+                *out_adapter = adapter.Detach();
+                return adapter_index;
             }
         }
 
-        *out_adapter = adapter.Detach();
+        return 0;
+    }
+
+    static std::string ToNarrowString(std::wstring_view input) {
+        if (input.empty()) return std::string();
+
+        const int size_needed = WideCharToMultiByte(CP_UTF8, 0, &input[0], (int)input.size(), NULL, 0, NULL, NULL);
+
+        std::string str_to(size_needed, 0);
+
+        WideCharToMultiByte(CP_UTF8, 0, &input[0], (int)input.size(), &str_to[0], size_needed, NULL, NULL);
+
+        return str_to;
     }
 
     Context::~Context() {
@@ -79,7 +112,16 @@ namespace DnmGL::D3D12 {
         }
 
         ComPtr<IDXGIAdapter1> hardware_adapter;
-        GetHardwareAdapter(factory.Get(), &hardware_adapter);
+        adapter_properties.index = GetHardwareAdapter(factory.Get(), &hardware_adapter, desc, true);
+        if (!hardware_adapter && (desc.adapter_index || desc.adapter_uuid)) {
+            Message("requested adapter not found or not suitable, choosing by preference", MessageType::eWarning);
+            adapter_properties.index = GetHardwareAdapter(factory.Get(), &hardware_adapter, desc, false);
+        }
+
+        if (!hardware_adapter) {
+            Message("No suitable GPU found", MessageType::eUnsupportedDevice);
+            return;
+        }
 
         D3D12CreateDevice(
             hardware_adapter.Get(),
@@ -87,6 +129,22 @@ namespace DnmGL::D3D12 {
             IID_PPV_ARGS(&m_device)
             );
 
+        {
+            DXGI_ADAPTER_DESC1 adapter_desc;
+            hardware_adapter->GetDesc1(&adapter_desc);
+
+            D3D12_FEATURE_DATA_ARCHITECTURE architecture{};
+            m_device->CheckFeatureSupport(D3D12_FEATURE_ARCHITECTURE, &architecture, sizeof(architecture));
+
+            adapter_properties.name = ToNarrowString(adapter_desc.Description);
+            adapter_properties.uuid = GetAdapterUuid(adapter_desc);
+            adapter_properties.vendor_id = adapter_desc.VendorId;
+            adapter_properties.device_id = adapter_desc.DeviceId;
+            adapter_properties.dedicated_memory = adapter_desc.DedicatedVideoMemory;
+            adapter_properties.type = (adapter_desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) ? AdapterType::eCpu
+                : architecture.UMA ? AdapterType::eIntegrated : AdapterType::eDiscrete;
+        }
+
         if constexpr (_debug) {
             ComPtr<ID3D12InfoQueue> iq;
             if (SUCCEEDED(m_device.As(&iq))) {}
@@ -182,7 +240,7 @@ namespace DnmGL::D3D12 {
         CreateResources();
     }
 
-    void Context::ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func) {
+    uint64_t Context::ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets) {
         WaitForGPU();
 
         DeleteObjects();
@@ -193,20 +251,25 @@ namespace DnmGL::D3D12 {
         {
             if (!func(m_command_buffer)) {
                 m_command_buffer->End();
-                return;
+                return 0;
             }
         }
         m_command_buffer->End();
 
+        if (!wait_tickets.empty())
+            m_command_queue->Wait(m_fence.Get(), std::ranges::max(wait_tickets));
+
         ID3D12CommandList *const command_lists[1] = { m_command_buffer->GetCommandList() };
         m_command_queue->ExecuteCommandLists(1, command_lists);
 
+        const auto ticket = m_fence_value;
         m_command_queue->Signal(m_fence.Get(), m_fence_value++);
 
         context_state = ContextState::eCommandExecuting;
+        return ticket;
     }
 
-    void Context::Render(const std::function<bool(DnmGL::CommandBuffer*)>& func) {
+    uint64_t Context::Render(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets) {
         WaitForGPU();
         
         DeleteObjects();
@@ -219,17 +282,22 @@ namespace DnmGL::D3D12 {
         {
             if (!func(m_command_buffer)) {
                 m_command_buffer->End();
-                return;
+                return 0;
             }
         }
         m_command_buffer->End();
 
+        if (!wait_tickets.empty())
+            m_command_queue->Wait(m_fence.Get(), std::ranges::max(wait_tickets));
+
         ID3D12CommandList *const command_lists[1] = { m_command_buffer->GetCommandList() };
         m_command_queue->ExecuteCommandLists(1, command_lists);
         m_swapchain->Present(0, DXGI_PRESENT_ALLOW_TEARING);
+        const auto ticket = m_fence_value;
         m_command_queue->Signal(m_fence.Get(), m_fence_value++);
 
         context_state = ContextState::eCommandExecuting;
+        return ticket;
     }
 
     void Context::CreateResources() {
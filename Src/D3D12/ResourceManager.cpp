@@ -135,8 +135,8 @@ namespace DnmGL::D3D12 {
                     .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
                     .Buffer = D3D12_BUFFER_SRV{
                         .FirstElement = res.first_element,
-                        .NumElements = res.element_count,
-                        .StructureByteStride = res.buffer->GetDesc().element_size,
+                        .NumElements = static_cast<UINT>(res.element_count),
+                        .StructureByteStride = static_cast<UINT>(res.buffer->GetDesc().element_size),
                         .Flags = D3D12_BUFFER_SRV_FLAG_NONE,
                     }
                 };
@@ -166,8 +166,8 @@ namespace DnmGL::D3D12 {
                     .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
                     .Buffer = D3D12_BUFFER_SRV{
                         .FirstElement = res.first_element,
-                        .NumElements = res.element_count,
-                        .StructureByteStride = res.buffer->GetDesc().element_size,
+                        .NumElements = static_cast<UINT>(res.element_count),
+                        .StructureByteStride = static_cast<UINT>(res.buffer->GetDesc().element_size),
                         .Flags = D3D12_BUFFER_SRV_FLAG_NONE,
                     }
                 };
@@ -1,4 +1,5 @@
 #include "DnmGL/Vulkan/Buffer.hpp"
+#include "DnmGL/Vulkan/Defragmenter.hpp"
 
 namespace DnmGL::Vulkan {
     static constexpr vk::BufferUsageFlags GetVkUsageFlags(DnmGL::BufferUsageFlags flags) {
@@ -24,13 +25,62 @@ namespace DnmGL::Vulkan {
         return vk_flag;
     }
 
-    Buffer::Buffer(Vulkan::Context& ctx, const DnmGL::BufferDesc& desc)
-    : DnmGL::Buffer(ctx, desc) {
+    static constexpr MemoryCategory GetMemoryCategory(DnmGL::BufferUsageFlags flags) {
+        if (flags.Has(BufferUsageBits::eVertex)) return MemoryCategory::eVertexBuffer;
+        if (flags.Has(BufferUsageBits::eIndex)) return MemoryCategory::eIndexBuffer;
+        if (flags.Has(BufferUsageBits::eUniform)) return MemoryCategory::eUniformBuffer;
+        if (flags.Has(BufferUsageBits::eWritebleResource)) return MemoryCategory::eWritableBuffer;
+        return MemoryCategory::eReadonlyBuffer;
+    }
+
+    static constexpr MemoryPoolType GetMemoryPoolType(const DnmGL::BufferDesc& desc) {
+        if (desc.memory_type == MemoryType::eHostMemory) return MemoryPoolType::eStaging;
+        if (desc.usage_flags.Has(BufferUsageBits::eVertex) || desc.usage_flags.Has(BufferUsageBits::eIndex)) 
+            return MemoryPoolType::eVertexIndex;
+        if (desc.usage_flags.Has(BufferUsageBits::eUniform)) return MemoryPoolType::eUniform;
+        return MemoryPoolType::eStorage;
+    }
+
+    VkBufferCreateInfo Buffer::GetCreateInfo(Vulkan::Context& context, const DnmGL::BufferDesc& desc) {
         VkBufferCreateInfo buffer_create_info{};
         buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        buffer_create_info.usage = static_cast<uint32_t>(GetVkUsageFlags(m_desc.usage_flags));
+        buffer_create_info.usage = static_cast<uint32_t>(GetVkUsageFlags(desc.usage_flags));
         buffer_create_info.sharingMode = VkSharingMode::VK_SHARING_MODE_EXCLUSIVE;
-        buffer_create_info.size = m_desc.element_size * m_desc.element_count;
+        if (const auto queue_families = context.GetSharedQueueFamilies(); !queue_families.empty()) {
+            buffer_create_info.sharingMode = VkSharingMode::VK_SHARING_MODE_CONCURRENT;
+            buffer_create_info.queueFamilyIndexCount = static_cast<uint32_t>(queue_families.size());
+            buffer_create_info.pQueueFamilyIndices = queue_families.data();
+        }
+        buffer_create_info.size = desc.GetSize();
+
+        return buffer_create_info;
+    }
+
+    Buffer::Buffer(Vulkan::Context& ctx, const DnmGL::BufferDesc& desc)
+    : DnmGL::Buffer(ctx, desc) {
+        CreateBuffer();
+    }
+
+    Buffer::Buffer(Vulkan::Context& ctx, const DnmGL::BufferDesc& desc, void *host_pointer)
+    : DnmGL::Buffer(ctx, desc) {
+        // host pointer is the mapped pointer, buffer memory needs no host access
+        m_desc.memory_host_access = MemoryHostAccess::eNone;
+
+        if (!ImportHostMemory(host_pointer)) {
+            CreateBuffer();
+            m_host_pointer = host_pointer;
+            VulkanContext->AddStagedBuffer(this);
+            // host memory is already written
+            m_dirty_ranges.emplace_back(0, 0, m_desc.GetSize());
+        }
+
+        m_desc.memory_host_access = MemoryHostAccess::eReadWrite;
+        m_mapped_ptr = reinterpret_cast<uint8_t*>(host_pointer);
+    }
+
+    void Buffer::CreateBuffer() {
+        const auto buffer_create_info = GetCreateInfo(*VulkanContext, m_desc);
+        const auto& desc = m_desc;
 
         VmaAllocationInfo alloc_info;
         VmaAllocationCreateInfo alloc_create_info{};
@@ -41,6 +91,15 @@ namespace DnmGL::Vulkan {
                 alloc_create_info.flags |= (VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT); break;
             case MemoryHostAccess::eWrite: 
                 alloc_create_info.flags |= (VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT); break;
+            // memory may not be host visible, then it is written through m_staging_buffer
+            case MemoryHostAccess::eDirectWrite: 
+                alloc_create_info.flags |= (VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT 
+                                        | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT 
+                                        | VMA_ALLOCATION_CREATE_MAPPED_BIT); break;
+            // coherency is not required, so cached memory types without it can be chosen
+            case MemoryHostAccess::eCachedRead: 
+                alloc_create_info.flags |= (VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+                alloc_create_info.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT; break;
         }
 
         switch (desc.memory_type) {
@@ -48,30 +107,209 @@ namespace DnmGL::Vulkan {
             case MemoryType::eHostMemory: alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST; break;
             case MemoryType::eDeviceMemory: alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE; break;
         }
+        if (desc.memory_host_access == MemoryHostAccess::eDirectWrite) 
+            alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+        if (desc.memory_host_access == MemoryHostAccess::eCachedRead) 
+            alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
 
-        const auto result = (vk::Result)vmaCreateBuffer(VulkanContext->GetVmaAllocator(), 
+        VulkanContext->ApplyMemoryPool(GetMemoryPoolType(m_desc), buffer_create_info.size, buffer_create_info, alloc_create_info);
+
+        auto result = (vk::Result)vmaCreateBuffer(VulkanContext->GetVmaAllocator(), 
                 &buffer_create_info, 
                 &alloc_create_info,
                 reinterpret_cast<VkBuffer*>(&m_buffer), 
                 &m_allocation, 
                 &alloc_info);
 
+        // pool block may be full or too small
+        if (alloc_create_info.pool && result != vk::Result::eSuccess) {
+            alloc_create_info.pool = VK_NULL_HANDLE;
+            result = (vk::Result)vmaCreateBuffer(VulkanContext->GetVmaAllocator(), 
+                &buffer_create_info, 
+                &alloc_create_info,
+                reinterpret_cast<VkBuffer*>(&m_buffer), 
+                &m_allocation, 
+                &alloc_info);
+        }
+
         if (result == vk::Result::eErrorOutOfDeviceMemory || result == vk::Result::eErrorOutOfHostMemory) {
             VulkanContext->Message("vmaCreateBuffer create buffer failed, out of memory", MessageType::eOutOfMemory);
         }
         else if (result != vk::Result::eSuccess) {
             VulkanContext->Message("vmaCreateBuffer create buffer failed, unknown", MessageType::eUnknown);
         }
+        else {
+            VulkanContext->TrackAllocation(m_allocation, GetMemoryCategory(m_desc.usage_flags));
+            VulkanContext->GetDefragmenter().AddBuffer(m_allocation, this);
+        }
         
         m_mapped_ptr = reinterpret_cast<uint8_t*>(alloc_info.pMappedData);
+
+        if (result == vk::Result::eSuccess && desc.memory_host_access == MemoryHostAccess::eDirectWrite) {
+            VkMemoryPropertyFlags memory_properties;
+            vmaGetAllocationMemoryProperties(VulkanContext->GetVmaAllocator(), m_allocation, &memory_properties);
+            if (!(memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) CreateStagingBuffer();
+        }
+    }
+
+    void Buffer::CreateStagingBuffer() {
+        VkBufferCreateInfo buffer_create_info{};
+        buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buffer_create_info.size = m_desc.GetSize();
+        buffer_create_info.sharingMode = VkSharingMode::VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo alloc_create_info{};
+        alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+        alloc_create_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo alloc_info;
+        const auto result = (vk::Result)vmaCreateBuffer(VulkanContext->GetVmaAllocator(), 
+                &buffer_create_info, 
+                &alloc_create_info,
+                reinterpret_cast<VkBuffer*>(&m_staging_buffer), 
+                &m_staging_allocation, 
+                &alloc_info);
+
+        if (result == vk::Result::eErrorOutOfDeviceMemory || result == vk::Result::eErrorOutOfHostMemory) {
+            VulkanContext->Message("vmaCreateBuffer create staging buffer failed, out of memory", MessageType::eOutOfMemory);
+            return;
+        }
+        else if (result != vk::Result::eSuccess) {
+            VulkanContext->Message("vmaCreateBuffer create staging buffer failed, unknown", MessageType::eUnknown);
+            return;
+        }
+
+        VulkanContext->TrackAllocation(m_staging_allocation, MemoryCategory::eStaging);
+        VulkanContext->AddStagedBuffer(this);
+        m_mapped_ptr = reinterpret_cast<uint8_t*>(alloc_info.pMappedData);
+    }
+
+    bool Buffer::ImportHostMemory(void *host_pointer) {
+        if (!VulkanContext->GetSupportedFeatures().external_memory_host) return false;
+
+        const auto size = m_desc.GetSize();
+        const auto alignment = VulkanContext->GetDeviceFeatures().min_imported_host_pointer_alignment;
+        if (reinterpret_cast<uintptr_t>(host_pointer) % alignment != 0 || size % alignment != 0) {
+            VulkanContext->Message(
+                std::format("host pointer and buffer size must be multiple of {} to be imported, buffer is staged", alignment), 
+                MessageType::eWarning);
+            return false;
+        }
+
+        const auto device = VulkanContext->GetDevice();
+        constexpr auto handle_type = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT;
+
+        vk::MemoryHostPointerPropertiesEXT host_pointer_properties{};
+        if (device.getMemoryHostPointerPropertiesEXT(handle_type, host_pointer, &host_pointer_properties, VulkanContext->GetDispatcher()) 
+            != vk::Result::eSuccess) {
+            return false;
+        }
+
+        auto buffer_create_info = GetCreateInfo(*VulkanContext, m_desc);
+        const vk::ExternalMemoryBufferCreateInfo external_create_info(handle_type);
+        buffer_create_info.pNext = &external_create_info;
+        m_buffer = device.createBuffer(reinterpret_cast<const vk::BufferCreateInfo&>(buffer_create_info));
+
+        // host writes must be visible without flushing
+        const auto memory_type_bits = device.getBufferMemoryRequirements(m_buffer).memoryTypeBits & host_pointer_properties.memoryTypeBits;
+        const auto memory_properties = VulkanContext->GetPhysicalDevice().getMemoryProperties();
+        std::optional<uint32_t> memory_type_index;
+        for (const auto i : Counter(memory_properties.memoryTypeCount)) {
+            if ((memory_type_bits & (1u << i)) 
+                && (memory_properties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent)) {
+                memory_type_index = i;
+                break;
+            }
+        }
+
+        const vk::ImportMemoryHostPointerInfoEXT import_info(handle_type, host_pointer);
+        const vk::MemoryAllocateInfo allocate_info(size, memory_type_index.value_or(0), &import_info);
+        if (!memory_type_index || device.allocateMemory(&allocate_info, nullptr, &m_imported_memory) != vk::Result::eSuccess) {
+            VulkanContext->Message("host memory import failed, buffer is staged", MessageType::eWarning);
+            device.destroy(m_buffer);
+            m_buffer = nullptr;
+            m_imported_memory = nullptr;
+            return false;
+        }
+
+        device.bindBufferMemory(m_buffer, m_imported_memory, 0);
+        return true;
+    }
+
+    uint8_t *Buffer::IMap() {
+        // host memory and staging buffers are always mapped
+        if (m_imported_memory || m_host_pointer || m_staging_buffer) return m_mapped_ptr;
+
+        void *mapped_ptr{};
+        if ((vk::Result)vmaMapAllocation(VulkanContext->GetVmaAllocator(), m_allocation, &mapped_ptr) != vk::Result::eSuccess) {
+            VulkanContext->Message("vmaMapAllocation failed", MessageType::eUnknown);
+            return nullptr;
+        }
+        return reinterpret_cast<uint8_t*>(mapped_ptr);
+    }
+
+    void Buffer::IUnmap() {
+        if (m_imported_memory || m_host_pointer || m_staging_buffer) return;
+
+        vmaUnmapAllocation(VulkanContext->GetVmaAllocator(), m_allocation);
+    }
+
+    // imported memory is host coherent
+    void Buffer::IFlushRange(uint64_t offset, uint64_t size) {
+        if (m_imported_memory) return;
+
+        // staged ranges are copied to the buffer at the begin of next frame
+        if (m_host_pointer || m_staging_buffer) m_dirty_ranges.emplace_back(offset, offset, size);
+        if (m_host_pointer) return;
+
+        vmaFlushAllocation(VulkanContext->GetVmaAllocator(), GetHostAllocation(), offset, size);
+    }
+
+    std::vector<vk::BufferCopy> Buffer::TakeDirtyRanges() {
+        if (m_dirty_ranges.size() < 2) return std::exchange(m_dirty_ranges, {});
+
+        // regions of one copy command must not overlap
+        std::ranges::sort(m_dirty_ranges, {}, &vk::BufferCopy::dstOffset);
+        std::vector<vk::BufferCopy> ranges{m_dirty_ranges.front()};
+        for (const auto& range : m_dirty_ranges | std::ranges::views::drop(1)) {
+            auto& last = ranges.back();
+            if (range.dstOffset <= last.dstOffset + last.size) {
+                last.size = std::max(last.size, range.dstOffset + range.size - last.dstOffset);
+                continue;
+            }
+            ranges.emplace_back(range);
+        }
+        m_dirty_ranges.clear();
+        return ranges;
+    }
+
+    void Buffer::IInvalidateRange(uint64_t offset, uint64_t size) {
+        if (m_imported_memory || m_host_pointer) return;
+
+        vmaInvalidateAllocation(VulkanContext->GetVmaAllocator(), GetHostAllocation(), offset, size);
     }
 
     Buffer::~Buffer() {
-        const auto buffer = m_buffer;
-        auto* allocation = m_allocation;
-        VulkanContext->DeleteObject(
-            [buffer, allocation] ([[maybe_unused]] vk::Device device, VmaAllocator allocator) -> void {
-                vmaDestroyBuffer(allocator, buffer, allocation);
-            });
+
+        if (m_imported_memory) {
+            VulkanContext->DeleteObject(m_buffer);
+            VulkanContext->DeleteObject(m_imported_memory);
+            return;
+        }
+
+        if (m_host_pointer) VulkanContext->RemoveStagedBuffer(this);
+
+        if (m_staging_buffer) {
+            VulkanContext->RemoveStagedBuffer(this);
+            VulkanContext->DeleteObject(m_staging_buffer, m_staging_allocation);
+        }
+
+        // memory moved by a pending defragmentation pass is freed by the pass
+        if (VulkanContext->GetDefragmenter().Remove(m_allocation)) {
+            VulkanContext->DeleteObject(m_buffer);
+            return;
+        }
+        VulkanContext->DeleteObject(m_buffer, m_allocation);
     }
 }
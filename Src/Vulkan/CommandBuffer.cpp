@@ -3,14 +3,20 @@
 #include "DnmGL/Vulkan/Buffer.hpp"
 #include "DnmGL/Vulkan/Image.hpp"
 #include "DnmGL/Vulkan/Framebuffer.hpp"
+#include "DnmGL/Vulkan/ResourceManager.hpp"
+#include "DnmGL/Vulkan/StagingRing.hpp"
+#include "DnmGL/Vulkan/ReadbackRing.hpp"
+#include "DnmGL/Vulkan/TransientAttachmentPool.hpp"
+
+#include <numeric>
 
 namespace DnmGL::Vulkan {
-    CommandBuffer::CommandBuffer(Vulkan::Context& ctx)
-        : DnmGL::CommandBuffer(ctx) {
+    CommandBuffer::CommandBuffer(Vulkan::Context& ctx, vk::CommandPool command_pool, vk::CommandBufferLevel level)
+        : DnmGL::CommandBuffer(ctx), m_command_pool(command_pool) {
         vk::CommandBufferAllocateInfo alloc_descs;
         alloc_descs.setCommandBufferCount(1)
-                    .setCommandPool(VulkanContext->GetCommandPool())
-                    .setLevel(vk::CommandBufferLevel::ePrimary);
+                    .setCommandPool(m_command_pool)
+                    .setLevel(level);
     
         command_buffer = VulkanContext->GetDevice().allocateCommandBuffers(alloc_descs)[0];
     }
@@ -22,12 +28,12 @@ namespace DnmGL::Vulkan {
 
         DeferLayoutTranslation();
 
-        command_buffer.bindDescriptorSets(
-                        vk::PipelineBindPoint::eCompute, 
-                        typed_pipeline->GetPipelineLayout(),
-                        0,
-                        typed_pipeline->GetDstSets(),
-                        {});
+        MarkSetsUsed(typed_pipeline->GetDstSets(), typed_pipeline->GetDesc().resource_manager);
+        BindDescriptorSets(
+            vk::PipelineBindPoint::eCompute, 
+            typed_pipeline->GetPipelineLayout(),
+            typed_pipeline->GetDstSets(),
+            typed_pipeline->GetDesc().resource_manager);
 
         command_buffer.bindPipeline(
             vk::PipelineBindPoint::eCompute, 
@@ -36,6 +42,82 @@ namespace DnmGL::Vulkan {
         prev_operation = CommandType::ePipeline;
     }
 
+    void CommandBuffer::IBindUniform(uint32_t binding, const TransientUniform& uniform, uint32_t array_element) {
+        const auto index = m_bound_resource_manager 
+                        ? m_bound_resource_manager->GetDynamicOffsetIndex(binding, array_element) 
+                        : std::nullopt;
+        if (!index) {
+            VulkanContext->Message(std::format("uniform binding {} is not used by the bound pipeline", binding), MessageType::eInvalidBehavior);
+            return;
+        }
+        if (uniform.buffer != VulkanContext->GetTransientUniformBuffer()) {
+            VulkanContext->Message("uniform must be allocated by Context::AllocateUniform", MessageType::eInvalidBehavior);
+            return;
+        }
+
+        m_dynamic_offsets[*index] = uniform.offset;
+
+        command_buffer.bindDescriptorSets(
+                        m_bind_point, 
+                        m_bound_pipeline_layout,
+                        2,
+                        m_bound_uniform_set,
+                        m_dynamic_offsets);
+    }
+
+    void CommandBuffer::IPushConstants(const DnmGL::GraphicsPipeline *pipeline, uint32_t offset, std::span<const std::byte> data) {
+        const auto* typed_pipeline = static_cast<const Vulkan::GraphicsPipelineBase *>(pipeline);
+        RecordPushConstants(typed_pipeline->GetPipelineLayout(), typed_pipeline->GetPushConstantRange(), offset, data);
+    }
+
+    void CommandBuffer::IPushConstants(const DnmGL::ComputePipeline *pipeline, uint32_t offset, std::span<const std::byte> data) {
+        const auto* typed_pipeline = static_cast<const Vulkan::ComputePipeline *>(pipeline);
+        RecordPushConstants(typed_pipeline->GetPipelineLayout(), typed_pipeline->GetPushConstantRange(), offset, data);
+    }
+
+    void CommandBuffer::RecordPushConstants(
+        vk::PipelineLayout pipeline_layout, 
+        const std::optional<vk::PushConstantRange>& range, 
+        uint32_t offset, 
+        std::span<const std::byte> data) {
+        const auto size = static_cast<uint32_t>(data.size());
+        if (!range || offset < range->offset || offset + size > range->offset + range->size) {
+            VulkanContext->Message(std::format("push constant range [{}, {}) is out of the pipeline's push constant block", offset, offset + size), 
+                                    MessageType::eInvalidBehavior);
+            return;
+        }
+
+        command_buffer.pushConstants(pipeline_layout, range->stageFlags, offset, size, data.data());
+    }
+
+    void CommandBuffer::MarkSetsUsed(std::span<const vk::DescriptorSet, 4> pipeline_sets, const DnmGL::ResourceManager *resource_manager) {
+        static_cast<const Vulkan::ResourceManager *>(resource_manager)->MarkSetsUsed(pipeline_sets);
+    }
+
+    void CommandBuffer::BindDescriptorSets(
+        vk::PipelineBindPoint bind_point, 
+        vk::PipelineLayout pipeline_layout, 
+        std::span<const vk::DescriptorSet, 4> pipeline_sets, 
+        const DnmGL::ResourceManager *resource_manager) {
+        const auto *typed_resource_manager = static_cast<const Vulkan::ResourceManager *>(resource_manager);
+        // sets of the resource manager are replaced when they are written while in use
+        const auto dst_sets = typed_resource_manager->GetBindSets(pipeline_sets);
+
+        m_bind_point = bind_point;
+        m_bound_pipeline_layout = pipeline_layout;
+        m_bound_uniform_set = dst_sets[2];
+        // empty set is bound if pipeline has no uniform
+        m_bound_resource_manager = dst_sets[2] == typed_resource_manager->GetUniformSet() ? typed_resource_manager : nullptr;
+        m_dynamic_offsets.assign(m_bound_resource_manager ? m_bound_resource_manager->GetDynamicOffsetCount() : 0, 0);
+
+        command_buffer.bindDescriptorSets(
+                        bind_point, 
+                        pipeline_layout,
+                        0,
+                        dst_sets,
+                        m_dynamic_offsets);
+    }
+
     void CommandBuffer::ICopyImageToBuffer(const DnmGL::ImageToBufferCopyDesc& desc) {
         auto* typed_src_image = static_cast<Vulkan::Image *>(desc.src_image);
         auto* typed_dst_buffer = static_cast<Vulkan::Buffer *>(desc.dst_buffer);
@@ -364,6 +446,12 @@ namespace DnmGL::Vulkan {
     }
 
     void CommandBuffer::IGenerateMipmaps(DnmGL::Image* image) {
+        //blit needs graphics queue
+        if (!(m_queue_flags & vk::QueueFlagBits::eGraphics)) {
+            VulkanContext->Message("GenerateMipmaps cannot be used in ExecuteUploadCommands or ExecuteComputeCommands", MessageType::eInvalidBehavior);
+            return;
+        }
+
         auto& image_desc = image->GetDesc();
         auto* typed_image = static_cast<Vulkan::Image*>(image);
 
@@ -516,11 +604,12 @@ namespace DnmGL::Vulkan {
             static_cast<vk::IndexType>(index_type));
     }
 
-    void CommandBuffer::IUploadData(DnmGL::Buffer *buffer, const void* data, uint32_t size, uint32_t offset) {
+    void CommandBuffer::IUploadData(DnmGL::Buffer *buffer, const void* data, uint64_t size, uint64_t offset) {
         auto *typed_buffer = static_cast<Vulkan::Buffer *>(buffer);
 
         //maybe this removed and upload func move to DnmGL.hpp for inlining
-        if (size < 65536) {
+        // vkCmdUpdateBuffer needs size and offset multiple of 4, others are copied from staging ring
+        if (size < 65536 && size % 4 == 0 && offset % 4 == 0) {
             auto *typed_buffer = static_cast<Vulkan::Buffer *>(buffer);
             
             Vulkan::BufferBarrier buffer_barrier[1] {
@@ -540,24 +629,29 @@ namespace DnmGL::Vulkan {
             return;
         }
 
-        //No problem, the Vulkan object is destroyed at the start of ExecuteCommands() or Render()
-        Vulkan::Buffer staging_buffer(*VulkanContext, {
-            .element_size = size,
-            .element_count = 1,
-            .memory_host_access = MemoryHostAccess::eWrite,
-            .memory_type = MemoryType::eAuto,
-            .usage_flags = {},
-        });
-
-        memcpy(staging_buffer.GetMappedPtr(), data, size);
-
-        ICopyBufferToBuffer({
-            .src_buffer = &staging_buffer,
-            .dst_buffer = typed_buffer,
-            .src_offset = offset,
-            .dst_offset = 0,
-            .copy_size = size,
-        });
+        // host writes are visible to the submission, so staging ring needs no barrier
+        const auto staging = VulkanContext->GetStagingRing().Write(data, size, 16);
+
+        Vulkan::BufferBarrier buffer_barrier[1] {
+            Vulkan::BufferBarrier{
+                .buffer = typed_buffer,
+                .src_pipeline_stages = typed_buffer->prev_pipeline_stage,
+                .dst_pipeline_stages = vk::PipelineStageFlagBits::eTransfer,
+                .src_access = typed_buffer->prev_access,
+                .dst_access = vk::AccessFlagBits::eTransferWrite
+            }
+        };
+
+        Barrier(buffer_barrier, {});
+
+        const vk::BufferCopy buffer_copy {
+            staging.offset,
+            offset,
+            size
+        };
+
+        command_buffer.copyBuffer(staging.buffer, typed_buffer->GetBuffer(), buffer_copy);
+        prev_operation = CommandType::eTransfer;
     }
 
     void CommandBuffer::IUploadData(
@@ -567,32 +661,161 @@ namespace DnmGL::Vulkan {
         Uint3 copy_extent, 
         Uint3 copy_offset) {
 
-        const auto copy_size = copy_extent.x * copy_extent.y * copy_extent.z * GetFormatSize(image->GetDesc().format);
-        //No problem, the Vulkan object is destroyed at the start of ExecuteCommands() or Render()
-        Vulkan::Buffer staging_buffer(*VulkanContext, {
-            .element_size = copy_size,
-            .element_count = 1,
-            .memory_host_access = MemoryHostAccess::eWrite,
-            .memory_type = MemoryType::eAuto,
-            .usage_flags = {},
-        });
-
-        memcpy(staging_buffer.GetMappedPtr(), data, copy_size);
-
-        ICopyBufferToImage({
-            .src_buffer = &staging_buffer,
-            .dst_image = image,
-            .image_subresource = subresource,
-            .buffer_offset = 0,
-            .copy_offset = copy_offset,
-            .copy_extent = copy_extent
-        });
+        auto* typed_image = static_cast<Vulkan::Image*>(image);
+        const auto format_size = GetFormatSize(image->GetDesc().format);
+        const auto copy_size = uint64_t(copy_extent.x) * copy_extent.y * copy_extent.z * subresource.layer_count * format_size;
+        // buffer offset must be multiple of texel size and 4
+        const auto staging = VulkanContext->GetStagingRing().Write(data, copy_size, std::lcm<uint64_t>(format_size, 16));
+
+        {
+            Vulkan::ImageBarrier image_barrier[1] {
+                Vulkan::ImageBarrier{
+                    .image = typed_image,
+                    .new_image_layout = vk::ImageLayout::eTransferDstOptimal,
+                    .src_pipeline_stages = typed_image->prev_pipeline_stage,
+                    .dst_pipeline_stages = vk::PipelineStageFlagBits::eTransfer,
+                    .src_access = typed_image->prev_access,
+                    .dst_access = vk::AccessFlagBits::eTransferWrite,
+                }
+            };
+
+            AddDeferLayoutTranslation(typed_image);
+
+            Barrier({}, image_barrier);
+        }
+
+        const vk::BufferImageCopy buffer_image_copy {
+            staging.offset,
+            0,
+            0,
+            vk::ImageSubresourceLayers(
+                typed_image->GetAspect(),
+                subresource.base_mipmap,
+                subresource.base_layer,
+                subresource.layer_count
+            ),
+            vk::Offset3D(copy_offset.x, copy_offset.y, copy_offset.z),
+            vk::Extent3D(copy_extent.x, copy_extent.y, copy_extent.z)
+        };
+
+        command_buffer.copyBufferToImage(
+            staging.buffer, 
+            typed_image->GetImage(), 
+            vk::ImageLayout::eTransferDstOptimal, 
+            buffer_image_copy);
+            
+        prev_operation = CommandType::eTransfer;
+    }
+
+    ReadbackHandle CommandBuffer::IRequestReadback(DnmGL::Buffer *buffer, uint64_t offset, uint64_t size) {
+        auto *typed_buffer = static_cast<Vulkan::Buffer *>(buffer);
+        const auto readback = VulkanContext->GetReadbackRing().Allocate(size, 16);
+
+        const auto buffer_barrier_needed = 
+            typed_buffer->prev_access != vk::AccessFlagBits::eTransferRead
+            && typed_buffer->prev_access != vk::AccessFlagBits::eShaderRead
+            && typed_buffer->prev_access != vk::AccessFlagBits::eUniformRead
+            && typed_buffer->prev_access != vk::AccessFlagBits::eVertexAttributeRead;
+
+        if (buffer_barrier_needed) {
+            const Vulkan::BufferBarrier buffer_barrier{
+                .buffer = typed_buffer,
+                .src_pipeline_stages = typed_buffer->prev_pipeline_stage,
+                .dst_pipeline_stages = vk::PipelineStageFlagBits::eTransfer,
+                .src_access = typed_buffer->prev_access,
+                .dst_access = vk::AccessFlagBits::eTransferRead
+            };
+
+            Barrier(std::span(&buffer_barrier, 1), {});
+        }
+
+        const vk::BufferCopy buffer_copy {
+            offset,
+            readback.offset,
+            size
+        };
+
+        command_buffer.copyBuffer(typed_buffer->GetBuffer(), readback.buffer, buffer_copy);
+        HostReadBarrier();
+        prev_operation = CommandType::eTransfer;
+        return readback.handle;
+    }
+
+    ReadbackHandle CommandBuffer::IRequestReadback(
+        DnmGL::Image *image, 
+        const ImageSubresource& subresource, 
+        Uint3 copy_extent, 
+        Uint3 copy_offset) {
+
+        auto* typed_image = static_cast<Vulkan::Image*>(image);
+        const auto format_size = GetFormatSize(image->GetDesc().format);
+        const auto copy_size = uint64_t(copy_extent.x) * copy_extent.y * copy_extent.z * subresource.layer_count * format_size;
+        // buffer offset must be multiple of texel size and 4
+        const auto readback = VulkanContext->GetReadbackRing().Allocate(copy_size, std::lcm<uint64_t>(format_size, 16));
+
+        // copy source must be in transfer src or general layout, other layouts are always translated
+        const auto image_layout = typed_image->GetImageLayout();
+        const bool copyable_layout = 
+            image_layout == vk::ImageLayout::eTransferSrcOptimal 
+            || image_layout == vk::ImageLayout::eGeneral;
+        const bool prev_access_is_read = 
+            typed_image->prev_access == vk::AccessFlagBits::eTransferRead
+            || typed_image->prev_access == vk::AccessFlagBits::eShaderRead;
+
+        if (!copyable_layout || !prev_access_is_read) {
+            const Vulkan::ImageBarrier image_barrier{
+                .image = typed_image,
+                .new_image_layout = copyable_layout ? image_layout : vk::ImageLayout::eTransferSrcOptimal,
+                .src_pipeline_stages = typed_image->prev_pipeline_stage,
+                .dst_pipeline_stages = vk::PipelineStageFlagBits::eTransfer,
+                .src_access = typed_image->prev_access,
+                .dst_access = vk::AccessFlagBits::eTransferRead,
+            };
+
+            if (!copyable_layout) AddDeferLayoutTranslation(typed_image);
+            Barrier({}, std::span(&image_barrier, 1));
+        }
+
+        const vk::BufferImageCopy buffer_image_copy {
+            readback.offset,
+            0,
+            0,
+            vk::ImageSubresourceLayers(
+                typed_image->GetAspect(),
+                subresource.base_mipmap,
+                subresource.base_layer,
+                subresource.layer_count
+            ),
+            vk::Offset3D(copy_offset.x, copy_offset.y, copy_offset.z),
+            vk::Extent3D(copy_extent.x, copy_extent.y, copy_extent.z)
+        };
+
+        command_buffer.copyImageToBuffer(
+            typed_image->GetImage(), 
+            typed_image->GetImageLayout(),
+            readback.buffer,
+            buffer_image_copy
+        );
+        HostReadBarrier();
+        prev_operation = CommandType::eTransfer;
+        return readback.handle;
+    }
+
+    void CommandBuffer::HostReadBarrier() const {
+        const vk::MemoryBarrier memory_barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer, 
+            vk::PipelineStageFlagBits::eHost, 
+            {}, 
+            memory_barrier, 
+            {}, 
+            {});
     }
 
     void CommandBuffer::IEndRendering() {
         if (VulkanContext->GetSupportedFeatures().dynamic_rendering) {
             command_buffer.endRenderingKHR(VulkanContext->GetDispatcher());
-            TranslateSwapchainImageLayoutsInEnd();
+            if (m_rendering_to_swapchain) TranslateSwapchainImageLayoutsInEnd();
         }
         else
             command_buffer.endRenderPass();
@@ -633,6 +856,23 @@ namespace DnmGL::Vulkan {
         }
     }
 
+    void CommandBuffer::IEndParallelRendering() {
+        std::vector<vk::CommandBuffer> secondary_command_buffers;
+        secondary_command_buffers.reserve(m_recorders.size());
+
+        for (auto* recorder : m_recorders) {
+            auto* typed_recorder = static_cast<Vulkan::CommandBuffer *>(recorder);
+            typed_recorder->command_buffer.end();
+            secondary_command_buffers.emplace_back(typed_recorder->command_buffer);
+            m_pending_layout_restore_images.merge(typed_recorder->m_pending_layout_restore_images);
+        }
+
+        command_buffer.executeCommands(secondary_command_buffers);
+        m_recorders.clear();
+
+        IEndRendering();
+    }
+
     // TODO: fix this
     void CommandBuffer::DeferLayoutTranslation() {
         if (!m_pending_layout_restore_images.size()) {
@@ -684,7 +924,7 @@ namespace DnmGL::Vulkan {
                 VK_QUEUE_FAMILY_IGNORED,
                 typed_buffer->GetBuffer(),
                 0,
-                typed_buffer->GetDesc().element_count * typed_buffer->GetDesc().element_size
+                typed_buffer->GetDesc().GetSize()
             );
 
             typed_buffer->prev_access = barrier.dst_access;
@@ -749,7 +989,7 @@ namespace DnmGL::Vulkan {
                 VK_QUEUE_FAMILY_IGNORED,
                 typed_buffer->GetBuffer(),
                 0,
-                typed_buffer->GetDesc().element_count * typed_buffer->GetDesc().element_size
+                typed_buffer->GetDesc().GetSize()
             );
 
             typed_buffer->prev_access = barrier.dst_access;
@@ -811,12 +1051,12 @@ namespace DnmGL::Vulkan {
 
         BarrierForPipeline(typed_pipeline->GetPipelineStageFlags(), typed_pipeline->GetAccessFlags());
 
-        command_buffer.bindDescriptorSets(
-                        vk::PipelineBindPoint::eGraphics, 
-                        typed_pipeline->GetPipelineLayout(),
-                        0,
-                        typed_pipeline->GetDstSets(),
-                        {});
+        MarkSetsUsed(typed_pipeline->GetDstSets(), typed_pipeline->GetDesc().resource_manager);
+        BindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics, 
+            typed_pipeline->GetPipelineLayout(),
+            typed_pipeline->GetDstSets(),
+            typed_pipeline->GetDesc().resource_manager);
 
         command_buffer.bindPipeline(
             vk::PipelineBindPoint::eGraphics, 
@@ -839,7 +1079,7 @@ namespace DnmGL::Vulkan {
             std::vector<Vulkan::ImageBarrier> image_barriers;
             image_barriers.reserve(typed_framebuffer->GetUserColorAttachments().size() + bool(typed_framebuffer->GetUserDepthStencilAttachment()));
 
-            TranslateAttachmentLayouts(*typed_framebuffer);            
+            TranslateAttachmentLayouts(*typed_framebuffer, desc.attachment_ops);            
         }
         else {
             const auto swapchain_extent = VulkanContext->GetSwapchainProperties().extent;
@@ -848,9 +1088,24 @@ namespace DnmGL::Vulkan {
                     ;
         }
 
+        if (m_recorders.empty()) {
+            command_buffer.beginRenderPass(
+                begin_desc, 
+                vk::SubpassContents::eInline);
+            return;
+        }
+
         command_buffer.beginRenderPass(
             begin_desc, 
-            vk::SubpassContents::eInline);
+            vk::SubpassContents::eSecondaryCommandBuffers);
+
+        vk::CommandBufferInheritanceInfo inheritance_info{};
+        inheritance_info.setRenderPass(vk_renderpass)
+                        .setSubpass(0)
+                        .setFramebuffer(begin_desc.framebuffer)
+                        ;
+
+        BeginRecorders(inheritance_info, typed_pipeline->GetPipelineLayout(), typed_pipeline->GetDstSets(), typed_pipeline->GetDesc().resource_manager, vk_pipeline);
     }
 
     void CommandBuffer::BeginRenderingDynamicRendering(const BeginRenderingDesc& desc) {
@@ -858,12 +1113,12 @@ namespace DnmGL::Vulkan {
         const auto vk_pipeline = typed_pipeline->GetPipeline();
         BarrierForPipeline(typed_pipeline->GetPipelineStageFlags(), typed_pipeline->GetAccessFlags());
 
-        command_buffer.bindDescriptorSets(
-                        vk::PipelineBindPoint::eGraphics, 
-                        typed_pipeline->GetPipelineLayout(),
-                        0,
-                        typed_pipeline->GetDstSets(),
-                        {});
+        MarkSetsUsed(typed_pipeline->GetDstSets(), typed_pipeline->GetDesc().resource_manager);
+        BindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics, 
+            typed_pipeline->GetPipelineLayout(),
+            typed_pipeline->GetDstSets(),
+            typed_pipeline->GetDesc().resource_manager);
 
         command_buffer.bindPipeline(
             vk::PipelineBindPoint::eGraphics, 
@@ -873,6 +1128,8 @@ namespace DnmGL::Vulkan {
         auto *typed_framebuffer = static_cast<Vulkan::FramebufferDynamicRendering *>(desc.framebuffer);
         vk::RenderingInfo rendering_info;
         rendering_info.setLayerCount(1);
+        if (!m_recorders.empty())
+            rendering_info.setFlags(vk::RenderingFlagBits::eContentsSecondaryCommandBuffers);
 
         if (desc.framebuffer != nullptr) {
             std::vector<vk::RenderingAttachmentInfo> color_attachments(typed_pipeline->ColorAttachmentCount() * (1 + typed_pipeline->HasMsaa()));
@@ -944,7 +1201,7 @@ namespace DnmGL::Vulkan {
 
             rendering_info.setRenderArea({{}, {typed_framebuffer->GetDesc().extent.x, typed_framebuffer->GetDesc().extent.y}});
             
-            TranslateAttachmentLayouts(*typed_framebuffer);
+            TranslateAttachmentLayouts(*typed_framebuffer, desc.attachment_ops);
 
             command_buffer.beginRenderingKHR(rendering_info, VulkanContext->GetDispatcher());
         }
@@ -994,9 +1251,60 @@ namespace DnmGL::Vulkan {
 
             command_buffer.beginRenderingKHR(rendering_info, VulkanContext->GetDispatcher());
         }
+
+        if (m_recorders.empty()) return;
+
+        //same formats with pipeline creation
+        std::vector<vk::Format> color_formats{};
+        for (const auto format : typed_pipeline->GetDesc().color_attachment_formats) {
+            color_formats.emplace_back(ToVkFormat(format));
+        }
+
+        vk::CommandBufferInheritanceRenderingInfo inheritance_rendering_info{};
+        inheritance_rendering_info.setColorAttachmentFormats(color_formats)
+                                .setRasterizationSamples(typed_pipeline->GetSampleCount())
+                                ;
+        if (typed_pipeline->HasDepthAttachment()) 
+            inheritance_rendering_info.setDepthAttachmentFormat(ToVkFormat(typed_pipeline->GetDesc().depth_stencil_format));
+        if (typed_pipeline->HasStencilAttachment()) 
+            inheritance_rendering_info.setStencilAttachmentFormat(ToVkFormat(typed_pipeline->GetDesc().depth_stencil_format));
+
+        vk::CommandBufferInheritanceInfo inheritance_info{};
+        inheritance_info.setPNext(&inheritance_rendering_info);
+
+        BeginRecorders(inheritance_info, typed_pipeline->GetPipelineLayout(), typed_pipeline->GetDstSets(), typed_pipeline->GetDesc().resource_manager, vk_pipeline);
     }
 
-    void CommandBuffer::TranslateAttachmentLayouts(FramebufferBase &framebuffer) {
+    void CommandBuffer::BeginRecorders(
+        const vk::CommandBufferInheritanceInfo& inheritance_info, 
+        vk::PipelineLayout pipeline_layout, 
+        std::span<const vk::DescriptorSet, 4> dst_sets, 
+        const DnmGL::ResourceManager *resource_manager,
+        vk::Pipeline pipeline) {
+        vk::CommandBufferBeginInfo begin_info{};
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue)
+                    .setPInheritanceInfo(&inheritance_info)
+                    ;
+
+        //bound state is not inherited, every recorder binds pipeline itself
+        for (auto* recorder : m_recorders) {
+            auto* typed_recorder = static_cast<Vulkan::CommandBuffer *>(recorder);
+            typed_recorder->command_buffer.begin(begin_info);
+
+            typed_recorder->BindDescriptorSets(
+                vk::PipelineBindPoint::eGraphics, 
+                pipeline_layout,
+                dst_sets,
+                resource_manager);
+
+            typed_recorder->command_buffer.bindPipeline(
+                vk::PipelineBindPoint::eGraphics, 
+                pipeline
+            );
+        }
+    }
+
+    void CommandBuffer::TranslateAttachmentLayouts(FramebufferBase &framebuffer, const AttachmentOps& attachment_ops) {
         std::vector<Vulkan::ImageBarrier> image_barriers;
         image_barriers.reserve(framebuffer.GetUserColorAttachments().size() + bool(framebuffer.GetUserDepthStencilAttachment()));
 
@@ -1024,6 +1332,34 @@ namespace DnmGL::Vulkan {
         }
 
         if (!image_barriers.empty()) Barrier({}, image_barriers);            
+
+        // memory of aliased attachments may be written by the previous pass of another framebuffer
+        std::vector<TransferImageLayoutNativeDesc> alias_barriers;
+        for (const auto i : Counter(framebuffer.GetMsaaColorAttachments().size())) {
+            auto& image = *framebuffer.GetMsaaColorAttachments()[i];
+            if (!image.IsAliased()) continue;
+
+            const bool is_discarded = VulkanContext->GetTransientAttachmentPool().MarkWritten(image.m_alias_allocation, &image);
+            if (!is_discarded && image.GetImageLayout() == vk::ImageLayout::eColorAttachmentOptimal) continue;
+
+            if (is_discarded && attachment_ops.color_load[i] == AttachmentLoadOp::eLoad) {
+                VulkanContext->Message(std::format("msaa color attachment {} is loaded but its memory was written by another framebuffer", i), 
+                    MessageType::eInvalidBehavior);
+            }
+            alias_barriers.emplace_back(
+                image.GetImage(),
+                image.GetAspect(),
+                is_discarded ? vk::ImageLayout::eUndefined : image.GetImageLayout(),
+                vk::ImageLayout::eColorAttachmentOptimal,
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                vk::AccessFlagBits::eColorAttachmentWrite,
+                vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eColorAttachmentRead
+            );
+            image.m_image_layout = vk::ImageLayout::eColorAttachmentOptimal;
+        }
+
+        if (!alias_barriers.empty()) TransferImageLayout(alias_barriers);
     }
 
     void CommandBuffer::TranslateSwapchainImageLayoutsInBegin() {
@@ -9,12 +9,24 @@
 #include "DnmGL/Vulkan/Pipeline.hpp"
 #include "DnmGL/Vulkan/Framebuffer.hpp"
 #include "DnmGL/Vulkan/Sampler.hpp"
+#include "DnmGL/Vulkan/StagingRing.hpp"
+#include "DnmGL/Vulkan/ReadbackRing.hpp"
+#include "DnmGL/Vulkan/TransientAttachmentPool.hpp"
+#include "DnmGL/Vulkan/Defragmenter.hpp"
+#include "DnmGL/Vulkan/TextureStreamer.hpp"
 #include "DnmGL/Vulkan/ToVkFormat.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <expected>
+#include <fstream>
+#include <limits>
 #include <print>
 #include <string>
+#include <thread>
 #include <vector>
 #include <format>
 #include <print>
@@ -22,6 +34,7 @@
 #define DISPATCH_VK_FUNC(func_name) dispatcher.func_name = reinterpret_cast<PFN_##func_name>(m_instance.getProcAddr(#func_name))
 
 namespace DnmGL::Vulkan {
+    //not required in headless context
     static const std::vector<const char*> required_extensions {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
@@ -211,12 +224,163 @@ namespace DnmGL::Vulkan {
         return out;
     }
 
-    bool CheckPhysicalDeviceFeatures(vk::PhysicalDevice physical_device, Context::SupportedFeatures& supported_features, std::string& out_message) {
+    static uint64_t GetDeviceLocalMemorySize(vk::PhysicalDevice physical_device) {
+        const auto memory_properties = physical_device.getMemoryProperties();
+        uint64_t size{};
+        for (const auto& heap : std::span(memory_properties.memoryHeaps.data(), memory_properties.memoryHeapCount)) {
+            if (heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+                size += heap.size;
+        }
+        return size;
+    }
+
+    static AdapterType ToAdapterType(vk::PhysicalDeviceType type) {
+        switch (type) {
+            case vk::PhysicalDeviceType::eIntegratedGpu: return AdapterType::eIntegrated;
+            case vk::PhysicalDeviceType::eDiscreteGpu: return AdapterType::eDiscrete;
+            case vk::PhysicalDeviceType::eVirtualGpu: return AdapterType::eVirtual;
+            case vk::PhysicalDeviceType::eCpu: return AdapterType::eCpu;
+            default: return AdapterType::eOther;
+        }
+    }
+
+    // type dominates, then device local memory in MiB, then dedicated queues
+    static uint64_t ScorePhysicalDevice(vk::PhysicalDevice physical_device) {
+        const auto properties = physical_device.getProperties();
+
+        uint64_t type_score{};
+        switch (properties.deviceType) {
+            case vk::PhysicalDeviceType::eDiscreteGpu: type_score = 4; break;
+            case vk::PhysicalDeviceType::eIntegratedGpu: type_score = 3; break;
+            case vk::PhysicalDeviceType::eVirtualGpu: type_score = 2; break;
+            case vk::PhysicalDeviceType::eCpu: type_score = 1; break;
+            default: break;
+        }
+
+        bool has_transfer_queue{};
+        bool has_compute_queue{};
+        for (const auto& queue_family : physical_device.getQueueFamilyProperties()) {
+            const auto flags = queue_family.queueFlags;
+            if (!(flags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))
+                && (flags & vk::QueueFlagBits::eTransfer))
+                has_transfer_queue = true;
+            if (!(flags & vk::QueueFlagBits::eGraphics) && (flags & vk::QueueFlagBits::eCompute))
+                has_compute_queue = true;
+        }
+
+        const uint64_t memory_score = std::min<uint64_t>(GetDeviceLocalMemorySize(physical_device) >> 20, (1ull << 48) - 1);
+        return (type_score << 56) | (memory_score << 8) | (has_transfer_queue << 1) | has_compute_queue;
+    }
+
+    // written before driver data of the pipeline cache
+    struct PipelineCacheFileHeader {
+        uint32_t magic;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint32_t driver_version;
+        std::array<uint8_t, VK_UUID_SIZE> pipeline_cache_uuid;
+        uint64_t data_size;
+        uint64_t data_hash;
+    };
+
+    static constexpr uint32_t PipelineCacheMagic = 0x504D4E44; // "DNMP"
+
+    // fnv-1a
+    static uint64_t HashPipelineCacheData(std::span<const uint8_t> data) {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (const auto byte : data) {
+            hash ^= byte;
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    static PipelineCacheFileHeader MakePipelineCacheFileHeader(const vk::PhysicalDeviceProperties& properties, std::span<const uint8_t> data) {
+        PipelineCacheFileHeader header{};
+        header.magic = PipelineCacheMagic;
+        header.vendor_id = properties.vendorID;
+        header.device_id = properties.deviceID;
+        header.driver_version = properties.driverVersion;
+        std::ranges::copy(properties.pipelineCacheUUID, header.pipeline_cache_uuid.begin());
+        header.data_size = data.size();
+        header.data_hash = HashPipelineCacheData(data);
+        return header;
+    }
+
+    // returns empty data if file does not exist
+    static std::expected<std::vector<uint8_t>, std::string> LoadPipelineCacheFile(const std::filesystem::path& path, const vk::PhysicalDeviceProperties& properties) {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file) return std::vector<uint8_t>{};
+
+        const auto file_size = static_cast<uint64_t>(file.tellg());
+        if (file_size < sizeof(PipelineCacheFileHeader)) 
+            return std::unexpected("file is too small");
+
+        PipelineCacheFileHeader header{};
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        const auto expected_header = MakePipelineCacheFileHeader(properties, {});
+        if (header.magic != PipelineCacheMagic)
+            return std::unexpected("invalid file");
+        if (header.vendor_id != expected_header.vendor_id 
+            || header.device_id != expected_header.device_id
+            || header.driver_version != expected_header.driver_version
+            || header.pipeline_cache_uuid != expected_header.pipeline_cache_uuid)
+            return std::unexpected("created by other device or driver");
+        if (header.data_size != file_size - sizeof(header))
+            return std::unexpected("file is truncated");
+
+        std::vector<uint8_t> data(header.data_size);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        if (!file || header.data_hash != HashPipelineCacheData(data))
+            return std::unexpected("data is corrupted");
+
+        // driver header, VkPipelineCacheHeaderVersionOne
+        struct {
+            uint32_t header_size;
+            uint32_t header_version;
+            uint32_t vendor_id;
+            uint32_t device_id;
+            std::array<uint8_t, VK_UUID_SIZE> pipeline_cache_uuid;
+        } driver_header{};
+        if (data.size() < sizeof(driver_header))
+            return std::unexpected("driver data is too small");
+
+        std::memcpy(&driver_header, data.data(), sizeof(driver_header));
+        if (driver_header.header_size < sizeof(driver_header)
+            || driver_header.header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            || driver_header.vendor_id != properties.vendorID
+            || driver_header.device_id != properties.deviceID
+            || driver_header.pipeline_cache_uuid != expected_header.pipeline_cache_uuid)
+            return std::unexpected("driver data does not match the device");
+
+        return data;
+    }
+
+    // grows on demand
+    static constexpr uint64_t StagingRingCapacity = 16 * 1024 * 1024;
+
+    struct PipelineManifestFileHeader {
+        uint32_t magic;
+        uint32_t entry_count;
+    };
+
+    struct PipelineManifestEntry {
+        uint64_t pipeline_key;
+        uint32_t attachment_ops;
+        uint32_t reserved;
+    };
+
+    static constexpr uint32_t PipelineManifestMagic = 0x4D4D4E44; // "DNMM"
+
+    bool CheckPhysicalDeviceFeatures(vk::PhysicalDevice physical_device, Context::SupportedFeatures& supported_features, std::string& out_message, bool headless) {
         vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering{};
         vk::PhysicalDeviceMemoryPriorityFeaturesEXT memory_priorty{};
         vk::PhysicalDevicePageableDeviceLocalMemoryFeaturesEXT pageable_device_local_memory{};
         vk::PhysicalDeviceSynchronization2FeaturesKHR sync2{};
         vk::PhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing{};
+        vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore{};
         vk::PhysicalDeviceVulkan11Features features11{};
         vk::PhysicalDeviceFeatures2 features{};
 
@@ -224,7 +388,8 @@ namespace DnmGL::Vulkan {
         pageable_device_local_memory.setPNext(&memory_priorty);
         sync2.setPNext(&pageable_device_local_memory);
         descriptor_indexing.setPNext(&sync2);
-        features11.setPNext(&descriptor_indexing);
+        timeline_semaphore.setPNext(&descriptor_indexing);
+        features11.setPNext(&timeline_semaphore);
         features.setPNext(&features11);
         physical_device.getFeatures2(&features);
 
@@ -239,7 +404,7 @@ namespace DnmGL::Vulkan {
         }
 
         if (const auto unsupported_exts = CheckDeviceExtensionSupport(physical_device, required_extensions);
-            !unsupported_exts.empty()) {
+            !headless && !unsupported_exts.empty()) {
             out_message = std::format("your gpu dont support this extensions: {}", unsupported_exts);
             return false;
         }
@@ -271,9 +436,32 @@ namespace DnmGL::Vulkan {
         supported_features.dynamic_rendering
             = dynamic_rendering.dynamicRendering;
 
+        supported_features.timeline_semaphore
+            = timeline_semaphore.timelineSemaphore
+            && CheckDeviceExtensionSupport(physical_device, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
         supported_features.memory_budget
             = CheckDeviceExtensionSupport(physical_device, "VK_EXT_memory_budget");
 
+        supported_features.external_memory_host
+            = CheckDeviceExtensionSupport(physical_device, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+
+        {
+            // usually only tile based gpus have it
+            const auto memory_properties = physical_device.getMemoryProperties();
+            supported_features.lazily_allocated_memory = std::ranges::any_of(
+                std::span(memory_properties.memoryTypes).first(memory_properties.memoryTypeCount),
+                [] (const vk::MemoryType& type) { return bool(type.propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated); });
+
+            // resizable bar, MemoryHostAccess::eDirectWrite buffers are staged without it
+            supported_features.host_visible_device_memory = std::ranges::any_of(
+                std::span(memory_properties.memoryTypes).first(memory_properties.memoryTypeCount),
+                [] (const vk::MemoryType& type) { 
+                    return (type.propertyFlags & (vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible)) 
+                        == (vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible); 
+                });
+        }
+
         return true;
     }
     
@@ -289,10 +477,34 @@ namespace DnmGL::Vulkan {
         if (m_resolve_image) delete m_resolve_image;
         if (placeholder_image) delete placeholder_image;
         if (placeholder_sampler) delete placeholder_sampler;
-        if (m_command_buffer) delete m_command_buffer;
+        m_staging_ring.reset();
+        m_readback_ring.reset();
+        m_transient_attachment_pool.reset();
+        if (m_transient_uniform_buffer) delete m_transient_uniform_buffer;
+        for (const auto& frame : m_frames) {
+            if (frame.command_buffer) delete frame.command_buffer;
+            for (auto* secondary_command_buffer : frame.secondary_command_buffers) {
+                delete secondary_command_buffer;
+            }
+        }
+        for (const auto& frame : m_transfer.frames) {
+            if (frame.command_buffer) delete frame.command_buffer;
+        }
+        for (const auto& frame : m_compute.frames) {
+            if (frame.command_buffer) delete frame.command_buffer;
+        }
         
+        m_completed_frame_count = std::numeric_limits<uint64_t>::max();
+        m_transfer.completed_count = std::numeric_limits<uint64_t>::max();
+        m_compute.completed_count = std::numeric_limits<uint64_t>::max();
         DeleteVulkanObjects();
         
+        // custom pools must outlive the defragmentation context
+        m_defragmenter.reset();
+        m_texture_streamer.reset();
+        for (const auto pool : m_memory_pools | std::ranges::views::values) {
+            vmaDestroyPool(m_vma_allocator, pool);
+        }
         if (m_vma_allocator) vmaDestroyAllocator(m_vma_allocator);
 
         for (const auto& framebuffers : m_framebuffers | std::ranges::views::values) {
@@ -305,13 +517,36 @@ namespace DnmGL::Vulkan {
             m_device.destroy(image_view);    
         }
         
-        if (m_pipeline_cache) m_device.destroy(m_pipeline_cache);
+        if (m_record_pipeline_manifest) SavePipelineManifest();
+        if (m_pipeline_cache) {
+            SavePipelineCache();
+            m_device.destroy(m_pipeline_cache);
+        }
         if (m_descriptor_pool) m_device.destroy(m_descriptor_pool);
-        if (m_command_pool) m_device.destroy(m_command_pool);
+        for (const auto& frame : m_frames) {
+            if (frame.command_pool) m_device.destroy(frame.command_pool);
+            for (const auto command_pool : frame.secondary_command_pools) {
+                m_device.destroy(command_pool);
+            }
+            if (frame.fence) m_device.destroy(frame.fence);
+            if (frame.acquire_next_image_semaphore) m_device.destroy(frame.acquire_next_image_semaphore);
+            if (frame.render_finished_semaphore) m_device.destroy(frame.render_finished_semaphore);
+        }
+        for (const auto& frame : m_transfer.frames) {
+            if (frame.command_pool) m_device.destroy(frame.command_pool);
+            if (frame.fence) m_device.destroy(frame.fence);
+        }
+        for (const auto& frame : m_compute.frames) {
+            if (frame.command_pool) m_device.destroy(frame.command_pool);
+            if (frame.fence) m_device.destroy(frame.fence);
+        }
+        for (const auto semaphore : m_pending_handoff_semaphores) {
+            m_device.destroy(semaphore);
+        }
+        if (m_transfer.timeline_semaphore) m_device.destroy(m_transfer.timeline_semaphore);
+        if (m_compute.timeline_semaphore) m_device.destroy(m_compute.timeline_semaphore);
+        if (m_timeline_semaphore) m_device.destroy(m_timeline_semaphore);
         if (m_swapchain) m_device.destroy(m_swapchain);
-        if (m_fence) m_device.destroy(m_fence);
-        if (m_acquire_next_image_semaphore) m_device.destroy(m_acquire_next_image_semaphore);
-        if (m_render_finished_semaphore) m_device.destroy(m_render_finished_semaphore);
         if (m_device) m_device.destroy();
         
         if (m_surface) m_instance.destroy(m_surface);
@@ -326,38 +561,53 @@ namespace DnmGL::Vulkan {
         shader_directory = desc.shader_directory;
         CreateInstance(GetWindowType(desc.window_handle));
         if constexpr (_debug) CreateDebugMessenger();
-        CreateSurface(desc.window_handle);
-        CreateDevice();
-        CreateCommandPool();
+        if (!IsHeadless()) CreateSurface(desc.window_handle);
+        CreateDevice(desc);
+        CreateFrames(desc.frames_in_flight);
+        CreateFrames(m_transfer, desc.frames_in_flight);
+        CreateFrames(m_compute, desc.frames_in_flight);
         CreateDescriptorPool();
-        CreateSwapchain(desc.swapchain_settings.window_extent, desc.swapchain_settings.Vsync);
+        if (!IsHeadless()) CreateSwapchain(desc.swapchain_settings.window_extent, desc.swapchain_settings.Vsync);
+        m_memory_pool_settings = desc.memory_pools;
         CreateVmaAllocator();
-        CreatePipelineCache();
+        m_defragmenter = std::make_unique<Vulkan::Defragmenter>(*this);
+        m_texture_streamer = std::make_unique<Vulkan::TextureStreamer>(*this, desc.texture_streaming_budget);
+        m_staging_ring = std::make_unique<Vulkan::StagingRing>(*this, StagingRingCapacity);
+        m_readback_ring = std::make_unique<Vulkan::ReadbackRing>(*this, desc.readback_ring_size);
+        m_transient_attachment_pool = std::make_unique<Vulkan::TransientAttachmentPool>(*this);
+        CreateTransientUniformBuffer(desc.transient_uniform_size);
+        CreatePipelineCache(desc.pipeline_cache_path);
+        LoadPipelineManifest(desc.pipeline_manifest_path);
+        m_record_pipeline_manifest = desc.record_pipeline_manifest;
         CreateResource();
     }
 
     void Context::CreateInstance(WindowType window_type) {
         std::vector<const char*> extensions;
-        extensions.emplace_back("VK_KHR_surface");
 
-        if constexpr (_os == OS::eWin) {
-            extensions.emplace_back("VK_KHR_win32_surface");
-        }
-        else if constexpr (_os == OS::eAndroid) {
-            extensions.emplace_back("VK_KHR_android_surface");
-        }
-        else if constexpr (_os == OS::eLinux) {
-            DnmGLAssert((window_type == WindowType::eWayland) || (window_type == WindowType::eX11), "unsupported window manager")
+        //headless context doesn't need any surface extension
+        if (window_type != WindowType::eNone) {
+            extensions.emplace_back("VK_KHR_surface");
 
-            if (window_type == WindowType::eWayland) {
-                extensions.emplace_back("VK_KHR_wayland_surface");
+            if constexpr (_os == OS::eWin) {
+                extensions.emplace_back("VK_KHR_win32_surface");
             }
-            else if (window_type == WindowType::eX11) {
-                extensions.emplace_back("VK_KHR_xlib_surface");
+            else if constexpr (_os == OS::eAndroid) {
+                extensions.emplace_back("VK_KHR_android_surface");
+            }
+            else if constexpr (_os == OS::eLinux) {
+                DnmGLAssert((window_type == WindowType::eWayland) || (window_type == WindowType::eX11), "unsupported window manager")
+
+                if (window_type == WindowType::eWayland) {
+                    extensions.emplace_back("VK_KHR_wayland_surface");
+                }
+                else if (window_type == WindowType::eX11) {
+                    extensions.emplace_back("VK_KHR_xlib_surface");
+                }
+            }
+            else {
+                static_assert((_os != OS::eMac) || (_os != OS::eIos), "mac and ios don't support yet");
             }
-        }
-        else {
-            static_assert((_os != OS::eMac) || (_os != OS::eIos), "mac and ios don't support yet");
         }
 
         if constexpr (_debug) extensions.emplace_back("VK_EXT_debug_utils");
@@ -408,6 +658,8 @@ namespace DnmGL::Vulkan {
             DISPATCH_VK_FUNC(vkCmdPipelineBarrier2KHR);
             DISPATCH_VK_FUNC(vkCmdBeginRenderingKHR);
             DISPATCH_VK_FUNC(vkCmdEndRenderingKHR);
+            DISPATCH_VK_FUNC(vkGetSemaphoreCounterValueKHR);
+            DISPATCH_VK_FUNC(vkWaitSemaphoresKHR);
         }
     }
     
@@ -427,21 +679,30 @@ namespace DnmGL::Vulkan {
     }
     
     void Context::CreateSurface(const WindowHandle& window_handle) {
-        auto win_handle = std::get<WinWindowHandle>(window_handle);
-
-        vk::Win32SurfaceCreateInfoKHR create_info{};
-        create_info.setHinstance(reinterpret_cast<HINSTANCE>(win_handle.hInstance));
-        create_info.setHwnd(reinterpret_cast<HWND>(win_handle.hwnd));
-
-        vkCreateWin32SurfaceKHR(
-            m_instance, 
-            (VkWin32SurfaceCreateInfoKHR*)&create_info, 
-            {},
-            (VkSurfaceKHR*)&m_surface);
+        // win32 surface types exist only if VK_USE_PLATFORM_WIN32_KHR is defined
+#ifdef OS_WIN
+        if (GetWindowType(window_handle) == WindowType::eWindows) {
+            auto win_handle = std::get<WinWindowHandle>(window_handle);
+
+            vk::Win32SurfaceCreateInfoKHR create_info{};
+            create_info.setHinstance(reinterpret_cast<HINSTANCE>(win_handle.hInstance));
+            create_info.setHwnd(reinterpret_cast<HWND>(win_handle.hwnd));
+
+            vkCreateWin32SurfaceKHR(
+                m_instance, 
+                (VkWin32SurfaceCreateInfoKHR*)&create_info, 
+                {},
+                (VkSurfaceKHR*)&m_surface);
+            return;
+        }
+#endif
+        Message("surface creation is not supported for this window type, use headless context", MessageType::eUnsupportedDevice);
     }
     
-    void Context::CreateDevice() {
-        std::vector<const char*> extensions(required_extensions);
+    void Context::CreateDevice(const ContextDesc& desc) {
+        std::vector<const char*> extensions{};
+        if (!IsHeadless())
+            extensions = required_extensions;
 
         if constexpr (_os == OS::eAndroid) 
             extensions.emplace_back("VK_ANDROID_external_memory_android_hardware_buffer");
@@ -452,17 +713,58 @@ namespace DnmGL::Vulkan {
             Message("failed to find GPUs with Vulkan support!", MessageType::eUnsupportedDevice);
         
         std::string out;
-        
-        // TODO: choose best gpu
-        for (auto& _device : physics_devices) { 
-            if (!CheckPhysicalDeviceFeatures(_device, supported_features, out))
-                continue;
+        const bool has_override = desc.adapter_index || desc.adapter_uuid;
+
+        const auto is_requested = [&desc] (uint32_t index, const vk::PhysicalDeviceIDProperties& id_properties) {
+            if (desc.adapter_uuid) return std::ranges::equal(*desc.adapter_uuid, id_properties.deviceUUID);
+            return index == *desc.adapter_index;
+        };
 
-            m_physical_device = _device;
+        // first pass only considers requested adapter
+        for (const bool use_override : {has_override, false}) {
+            uint64_t best_score{};
+            for (const uint32_t i : Counter(physics_devices.size())) {
+                const auto _device = physics_devices[i];
+
+                vk::PhysicalDeviceIDProperties id_properties{};
+                vk::PhysicalDeviceProperties2 properties{};
+                properties.setPNext(&id_properties);
+                _device.getProperties2(&properties);
+
+                if (use_override && !is_requested(i, id_properties))
+                    continue;
+
+                SupportedFeatures features{};
+                if (!CheckPhysicalDeviceFeatures(_device, features, out, IsHeadless()))
+                    continue;
+
+                const auto score = ScorePhysicalDevice(_device);
+                if (m_physical_device != VK_NULL_HANDLE && score <= best_score)
+                    continue;
+
+                best_score = score;
+                supported_features = features;
+                m_physical_device = _device;
+                adapter_properties.index = i;
+                std::ranges::copy(id_properties.deviceUUID, adapter_properties.uuid.begin());
+            }
+
+            if (m_physical_device != VK_NULL_HANDLE || !use_override) break;
+            Message("requested adapter not found or not suitable, choosing by score", MessageType::eWarning);
         }
         
         if (m_physical_device == VK_NULL_HANDLE) {
             Message(std::format("No suitable GPU found: {}", out), MessageType::eUnsupportedDevice);
+            return;
+        }
+
+        {
+            const auto properties = m_physical_device.getProperties();
+            adapter_properties.name = std::string(properties.deviceName.data());
+            adapter_properties.vendor_id = properties.vendorID;
+            adapter_properties.device_id = properties.deviceID;
+            adapter_properties.dedicated_memory = GetDeviceLocalMemorySize(m_physical_device);
+            adapter_properties.type = ToAdapterType(properties.deviceType);
         }
 
         vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering{};
@@ -470,6 +772,7 @@ namespace DnmGL::Vulkan {
         vk::PhysicalDevicePageableDeviceLocalMemoryFeaturesEXT pageable_device_local_memory{};
         vk::PhysicalDeviceSynchronization2FeaturesKHR sync2{};
         vk::PhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing{};
+        vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore{};
         vk::PhysicalDeviceVulkan11Features features11{};
         vk::PhysicalDeviceFeatures2 features{};
 
@@ -477,7 +780,8 @@ namespace DnmGL::Vulkan {
         pageable_device_local_memory.setPNext(&memory_priorty);
         sync2.setPNext(&pageable_device_local_memory);
         descriptor_indexing.setPNext(&sync2);
-        features11.setPNext(&descriptor_indexing);
+        timeline_semaphore.setPNext(&descriptor_indexing);
+        features11.setPNext(&timeline_semaphore);
         features.setPNext(&features11);
 
         features11.shaderDrawParameters = vk::True;
@@ -491,6 +795,7 @@ namespace DnmGL::Vulkan {
         pageable_device_local_memory.pageableDeviceLocalMemory = supported_features.pageable_device_local_memory;
         sync2.synchronization2 = supported_features.sync2;
         dynamic_rendering.dynamicRendering = supported_features.dynamic_rendering;
+        timeline_semaphore.timelineSemaphore = supported_features.timeline_semaphore;
 
         if (supported_features.sync2) {
             extensions.emplace_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
@@ -515,6 +820,12 @@ namespace DnmGL::Vulkan {
             extensions.emplace_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
             extensions.emplace_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
         }
+        if (supported_features.timeline_semaphore) {
+            extensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        }
+        if (supported_features.external_memory_host) {
+            extensions.emplace_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        }
 
         Message(std::format("{}", std::string(supported_features)), MessageType::eInfo);
     
@@ -529,15 +840,76 @@ namespace DnmGL::Vulkan {
             queue_family_index++;
         }
         device_features.queue_family = queue_family_index;
+
+        // transfer only queue, copies run on dma engine without blocking graphics queue
+        device_features.transfer_queue_family = device_features.queue_family;
+        queue_family_index = 0;
+        for (auto queue_family : m_physical_device.getQueueFamilyProperties()) {
+            const bool transfer_only = (queue_family.queueFlags & vk::QueueFlagBits::eTransfer)
+                && !(queue_family.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+            // copies can have any offset and extent
+            const bool granularity_is_one = queue_family.minImageTransferGranularity == vk::Extent3D(1, 1, 1);
+
+            if (transfer_only && granularity_is_one) {
+                device_features.transfer_queue_family = queue_family_index;
+                break;
+            }
+
+            queue_family_index++;
+        }
+
+        // compute only queue, runs with graphics queue at the same time
+        device_features.compute_queue_family = device_features.queue_family;
+        queue_family_index = 0;
+        for (auto queue_family : m_physical_device.getQueueFamilyProperties()) {
+            if (!desc.async_compute) break;
+
+            if ((queue_family.queueFlags & vk::QueueFlagBits::eCompute) && !(queue_family.queueFlags & vk::QueueFlagBits::eGraphics)) {
+                device_features.compute_queue_family = queue_family_index;
+                break;
+            }
+
+            queue_family_index++;
+        }
+
+        if (supported_features.external_memory_host) {
+            vk::PhysicalDeviceExternalMemoryHostPropertiesEXT external_memory_host_properties{};
+            vk::PhysicalDeviceProperties2 properties{};
+            properties.setPNext(&external_memory_host_properties);
+            m_physical_device.getProperties2(&properties);
+            device_features.min_imported_host_pointer_alignment = external_memory_host_properties.minImportedHostPointerAlignment;
+        }
+
+        const bool has_transfer_queue = device_features.transfer_queue_family != device_features.queue_family;
+        const bool has_compute_queue = device_features.compute_queue_family != device_features.queue_family;
     
         float queue_priority = 1.0f;
-        vk::DeviceQueueCreateInfo queue_create_info;
-        queue_create_info.setPQueuePriorities(&queue_priority)
+        std::vector<vk::DeviceQueueCreateInfo> queue_create_infos{};
+        queue_create_infos.emplace_back()
+        .setPQueuePriorities(&queue_priority)
         .setQueueFamilyIndex(device_features.queue_family)
         .setQueueCount(1);
+        if (has_transfer_queue) 
+            queue_create_infos.emplace_back()
+            .setPQueuePriorities(&queue_priority)
+            .setQueueFamilyIndex(device_features.transfer_queue_family)
+            .setQueueCount(1);
+        if (has_compute_queue) 
+            queue_create_infos.emplace_back()
+            .setPQueuePriorities(&queue_priority)
+            .setQueueFamilyIndex(device_features.compute_queue_family)
+            .setQueueCount(1);
+
+        // resources are shared instead of ownership transfer, compute queue cannot know written resources
+        // and transfer queue also writes and reads resources graphics queue already used (partial uploads, readbacks)
+        if (has_compute_queue || has_transfer_queue) {
+            for (const auto& queue_create_info : queue_create_infos) {
+                m_shared_queue_families.emplace_back(queue_create_info.queueFamilyIndex);
+            }
+        }
     
         vk::DeviceCreateInfo deviceCreateInfo;
-        deviceCreateInfo.setQueueCreateInfos(queue_create_info)
+        deviceCreateInfo.setQueueCreateInfos(queue_create_infos)
                         .setEnabledExtensionCount(extensions.size())
                         .setPEnabledExtensionNames(extensions)
                         .setPNext(&features);
@@ -545,34 +917,331 @@ namespace DnmGL::Vulkan {
         m_device = m_physical_device.createDevice(deviceCreateInfo);
         
         m_queue = m_device.getQueue(device_features.queue_family, 0);    
-        m_fence = m_device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
-        m_acquire_next_image_semaphore = m_device.createSemaphore({});
-        m_render_finished_semaphore = m_device.createSemaphore({});
+
+        m_transfer.queue_family = device_features.transfer_queue_family;
+        m_transfer.queue = has_transfer_queue ? m_device.getQueue(device_features.transfer_queue_family, 0) : m_queue;
+        m_compute.queue_family = device_features.compute_queue_family;
+        m_compute.queue = has_compute_queue ? m_device.getQueue(device_features.compute_queue_family, 0) : m_queue;
+
+        if (supported_features.timeline_semaphore) {
+            vk::SemaphoreTypeCreateInfoKHR type_info{};
+            type_info.setSemaphoreType(vk::SemaphoreType::eTimeline)
+                    .setInitialValue(0);
+
+            m_timeline_semaphore = m_device.createSemaphore(vk::SemaphoreCreateInfo{}.setPNext(&type_info));
+            m_transfer.timeline_semaphore = m_device.createSemaphore(vk::SemaphoreCreateInfo{}.setPNext(&type_info));
+            m_compute.timeline_semaphore = m_device.createSemaphore(vk::SemaphoreCreateInfo{}.setPNext(&type_info));
+        }
     }
     
-    void Context::CreateCommandPool() {
+    void Context::CreateFrames(uint32_t frames_in_flight) {
         vk::CommandPoolCreateInfo create_info{};
         create_info.setQueueFamilyIndex(device_features.queue_family);
-    
-        m_command_pool = m_device.createCommandPool(create_info);
-    
-        m_command_buffer = new CommandBuffer(*this);
+
+        m_frames.resize(frames_in_flight);
+        for (auto& frame : m_frames) {
+            frame.command_pool = m_device.createCommandPool(create_info);
+            frame.command_buffer = new CommandBuffer(*this, frame.command_pool);
+            frame.fence = m_device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+            if (!IsHeadless()) {
+                frame.acquire_next_image_semaphore = m_device.createSemaphore({});
+                frame.render_finished_semaphore = m_device.createSemaphore({});
+            }
+        }
+    }
+
+    void Context::CreateFrames(QueueData& queue, uint32_t frames_in_flight) {
+        vk::CommandPoolCreateInfo create_info{};
+        create_info.setQueueFamilyIndex(queue.queue_family);
+
+        const auto queue_flags = m_physical_device.getQueueFamilyProperties()[queue.queue_family].queueFlags;
+
+        queue.frames.resize(frames_in_flight);
+        for (auto& frame : queue.frames) {
+            frame.command_pool = m_device.createCommandPool(create_info);
+            frame.command_buffer = new CommandBuffer(*this, frame.command_pool);
+            frame.command_buffer->m_queue_flags = queue_flags;
+            frame.command_buffer->compute_queue = &queue == &m_compute;
+            frame.fence = m_device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+        }
+    }
+
+    void Context::ResetCommandPools(FrameData& frame) {
+        m_device.resetCommandPool(frame.command_pool);
+        for (const auto command_pool : frame.secondary_command_pools) {
+            m_device.resetCommandPool(command_pool);
+        }
+    }
+
+    std::span<Vulkan::CommandBuffer* const> Context::GetSecondaryCommandBuffers(uint32_t count) {
+        auto& frame = m_frames[GetFrameIndex()];
+
+        vk::CommandPoolCreateInfo create_info{};
+        create_info.setFlags(vk::CommandPoolCreateFlagBits::eTransient)
+                    .setQueueFamilyIndex(device_features.queue_family)
+                    ;
+
+        while (frame.secondary_command_buffers.size() < count) {
+            const auto command_pool = m_device.createCommandPool(create_info);
+            frame.secondary_command_pools.emplace_back(command_pool);
+            frame.secondary_command_buffers.emplace_back(
+                new CommandBuffer(*this, command_pool, vk::CommandBufferLevel::eSecondary));
+        }
+
+        return std::span(frame.secondary_command_buffers).first(count);
     }
 
     void Context::CreateDescriptorPool() {
-        vk::DescriptorPoolSize pool_sizes[4];
-        pool_sizes[0].setType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(512);
-        pool_sizes[1].setType(vk::DescriptorType::eUniformBuffer).setDescriptorCount(512);
-        pool_sizes[2].setType(vk::DescriptorType::eCombinedImageSampler).setDescriptorCount(512);
-        pool_sizes[3].setType(vk::DescriptorType::eStorageImage).setDescriptorCount(512);
+        // sets written while in use are replaced, replaced ones live until the frames using them are completed
+        const uint32_t count = 512 * (GetFramesInFlight() + 1);
+
+        vk::DescriptorPoolSize pool_sizes[7];
+        pool_sizes[0].setType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(count);
+        pool_sizes[1].setType(vk::DescriptorType::eUniformBuffer).setDescriptorCount(count);
+        pool_sizes[2].setType(vk::DescriptorType::eCombinedImageSampler).setDescriptorCount(count);
+        pool_sizes[3].setType(vk::DescriptorType::eStorageImage).setDescriptorCount(count);
+        pool_sizes[4].setType(vk::DescriptorType::eUniformBufferDynamic).setDescriptorCount(count);
+        pool_sizes[5].setType(vk::DescriptorType::eSampledImage).setDescriptorCount(count);
+        pool_sizes[6].setType(vk::DescriptorType::eSampler).setDescriptorCount(count);
 
         m_descriptor_pool = m_device.createDescriptorPool(
             vk::DescriptorPoolCreateInfo{}
-                .setFlags({})
-                .setMaxSets(512)
+                .setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+                .setMaxSets(count)
                 .setPoolSizes(pool_sizes));
     }
     
+    void Context::CreateTransientUniformBuffer(uint32_t size) {
+        const auto& limits = m_physical_device.getProperties().limits;
+        const auto alignment = static_cast<uint32_t>(limits.minUniformBufferOffsetAlignment);
+
+        m_transient_uniform_alignment = alignment;
+        m_transient_uniform_size = (size + alignment - 1) / alignment * alignment;
+        m_transient_uniform_range = std::min<uint32_t>(limits.maxUniformBufferRange, 65536);
+        m_transient_uniform_buffer = new Vulkan::Buffer(*this, {
+            .element_size = m_transient_uniform_size * GetFramesInFlight() + m_transient_uniform_range,
+            .element_count = 1,
+            .memory_host_access = MemoryHostAccess::eWrite,
+            .memory_type = MemoryType::eAuto,
+            .usage_flags = BufferUsageBits::eUniform,
+        });
+    }
+
+    TransientUniform Context::AllocateUniform(const void *data, uint32_t size) {
+        if (context_state != ContextState::eCommandBufferRecording) {
+            Message("AllocateUniform must be called while recording ExecuteCommands or Render", MessageType::eInvalidState);
+            return {};
+        }
+
+        // recorders can allocate from different threads, sizes are aligned so every offset stays aligned
+        const auto alignment = m_transient_uniform_alignment;
+        const uint64_t aligned_size = (uint64_t(size) + alignment - 1) / alignment * alignment;
+        const auto offset = m_transient_uniform_offset.fetch_add(aligned_size, std::memory_order_relaxed);
+        if (offset + size > m_transient_uniform_size || size > m_transient_uniform_range) {
+            Message("transient uniform memory of the frame is exhausted, increase ContextDesc::transient_uniform_size", MessageType::eOutOfMemory);
+            return {};
+        }
+
+        const auto frame_offset = static_cast<uint32_t>(GetFrameIndex() * m_transient_uniform_size + offset);
+        std::memcpy(m_transient_uniform_buffer->GetMappedPtr() + frame_offset, data, size);
+        vmaFlushAllocation(m_vma_allocator, m_transient_uniform_buffer->GetAllocation(), frame_offset, size);
+
+        return {m_transient_uniform_buffer, frame_offset, size};
+    }
+
+    std::span<const std::byte> Context::GetReadbackData(ReadbackHandle handle) {
+        return m_readback_ring->GetData(handle);
+    }
+
+    void Context::ReleaseReadback(ReadbackHandle handle) {
+        m_readback_ring->Release(handle);
+    }
+
+    void Context::TrackAllocation(VmaAllocation allocation, MemoryCategory category) {
+        if (!allocation) return;
+
+        // category is kept in user data, deferred deletion only knows the allocation
+        vmaSetAllocationUserData(m_vma_allocator, allocation, reinterpret_cast<void*>(static_cast<uintptr_t>(category) + 1));
+
+        VmaAllocationInfo alloc_info;
+        vmaGetAllocationInfo(m_vma_allocator, allocation, &alloc_info);
+
+        auto& stats = m_memory_categories[static_cast<size_t>(category)];
+        stats.bytes += alloc_info.size;
+        ++stats.allocation_count;
+
+        if (IsLazilyAllocated(alloc_info.memoryType)) m_lazily_allocated_bytes += alloc_info.size;
+    }
+
+    void Context::RecordFrameUploads(Vulkan::CommandBuffer& command_buffer) {
+        if (m_texture_streamer->Update(command_buffer)) command_buffer.DeferLayoutTranslation();
+
+        // only ranges passed to Buffer::FlushRange are copied
+        std::vector<std::pair<Vulkan::Buffer *, std::vector<vk::BufferCopy>>> uploads{};
+        for (auto *buffer : m_staged_buffers) {
+            auto ranges = buffer->TakeDirtyRanges();
+            if (!ranges.empty()) uploads.emplace_back(buffer, std::move(ranges));
+        }
+        if (uploads.empty()) return;
+
+        std::vector<Vulkan::BufferBarrier> buffer_barriers{};
+        buffer_barriers.reserve(uploads.size());
+        for (auto *buffer : uploads | std::ranges::views::keys) {
+            buffer_barriers.emplace_back(
+                buffer,
+                buffer->prev_pipeline_stage,
+                vk::PipelineStageFlagBits::eTransfer,
+                buffer->prev_access,
+                vk::AccessFlagBits::eTransferWrite
+            );
+        }
+        command_buffer.Barrier(buffer_barriers, {});
+
+        for (auto& [buffer, ranges] : uploads) {
+            // host memory that can't be imported is copied through staging ring
+            if (const auto *host_pointer = static_cast<const std::byte *>(buffer->GetHostPointer())) {
+                for (auto& range : ranges) {
+                    const auto staging = m_staging_ring->Write(host_pointer + range.dstOffset, range.size, 16);
+                    range.srcOffset = staging.offset;
+                    command_buffer.command_buffer.copyBuffer(staging.buffer, buffer->GetBuffer(), range);
+                }
+            }
+            // staging memory is flushed by Buffer::FlushRange
+            else {
+                command_buffer.command_buffer.copyBuffer(buffer->GetStagingBuffer(), buffer->GetBuffer(), ranges);
+            }
+
+            buffer->prev_pipeline_stage = vk::PipelineStageFlagBits::eTransfer;
+            buffer->prev_access = vk::AccessFlagBits::eTransferWrite;
+        }
+        command_buffer.prev_operation = Vulkan::CommandBuffer::CommandType::eTransfer;
+    }
+
+    void Context::RewriteResources(const std::unordered_set<const void *>& resources) {
+        for (auto *resource_manager : m_resource_managers) {
+            resource_manager->RewriteResources(resources);
+        }
+    }
+
+    DefragmentationStats Context::Defragment(const DefragmentationDesc& desc) {
+        if (context_state == ContextState::eCommandBufferRecording) {
+            Message("Defragment can't be called while recording", MessageType::eInvalidState);
+            return {};
+        }
+
+        DefragmentationStats stats{};
+        // one pass at a time, it ends after the frame that copied it is completed
+        if (!m_defragmenter->EndPass(stats) || stats.finished) return stats;
+
+        m_defragmenter->BeginPass(desc, stats);
+        return stats;
+    }
+
+    void Context::ApplyMemoryPool(MemoryPoolType type, uint64_t size, const VkBufferCreateInfo& buffer_info, VmaAllocationCreateInfo& alloc_create_info) {
+        const auto& pool_desc = m_memory_pool_settings[type];
+        if (pool_desc.dedicated_threshold && size >= pool_desc.dedicated_threshold) {
+            alloc_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+            return;
+        }
+
+        uint32_t memory_type_index;
+        if (vmaFindMemoryTypeIndexForBufferInfo(m_vma_allocator, &buffer_info, &alloc_create_info, &memory_type_index) != VK_SUCCESS) return;
+
+        alloc_create_info.pool = GetOrCreateMemoryPool(type, memory_type_index);
+    }
+
+    void Context::ApplyMemoryPool(MemoryPoolType type, uint64_t size, const VkImageCreateInfo& image_info, VmaAllocationCreateInfo& alloc_create_info) {
+        const auto& pool_desc = m_memory_pool_settings[type];
+        if (pool_desc.dedicated_threshold && size >= pool_desc.dedicated_threshold) {
+            alloc_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+            return;
+        }
+
+        uint32_t memory_type_index;
+        if (vmaFindMemoryTypeIndexForImageInfo(m_vma_allocator, &image_info, &alloc_create_info, &memory_type_index) != VK_SUCCESS) return;
+
+        alloc_create_info.pool = GetOrCreateMemoryPool(type, memory_type_index);
+    }
+
+    VmaPool Context::GetOrCreateMemoryPool(MemoryPoolType type, uint32_t memory_type_index) {
+        auto [it, is_inserted] = m_memory_pools.try_emplace({type, memory_type_index}, VK_NULL_HANDLE);
+        if (!is_inserted) return it->second;
+
+        VmaPoolCreateInfo pool_create_info{};
+        pool_create_info.memoryTypeIndex = memory_type_index;
+        pool_create_info.blockSize = m_memory_pool_settings[type].block_size;
+        pool_create_info.priority = (type == MemoryPoolType::eRenderTarget) ? 1.f : 0.5f;
+
+        if (vmaCreatePool(m_vma_allocator, &pool_create_info, &it->second) != VK_SUCCESS) {
+            Message("vmaCreatePool failed, resources are allocated from default pools", MessageType::eWarning);
+            m_memory_pools.erase(it);
+            return VK_NULL_HANDLE;
+        }
+
+        return it->second;
+    }
+
+    void Context::UntrackAllocation(VmaAllocation allocation) {
+        if (!allocation) return;
+
+        VmaAllocationInfo alloc_info;
+        vmaGetAllocationInfo(m_vma_allocator, allocation, &alloc_info);
+        if (!alloc_info.pUserData) return;
+
+        auto& stats = m_memory_categories[reinterpret_cast<uintptr_t>(alloc_info.pUserData) - 1];
+        stats.bytes -= alloc_info.size;
+        --stats.allocation_count;
+
+        if (IsLazilyAllocated(alloc_info.memoryType)) m_lazily_allocated_bytes -= alloc_info.size;
+    }
+
+    bool Context::IsLazilyAllocated(uint32_t memory_type) const noexcept {
+        VkMemoryPropertyFlags flags;
+        vmaGetMemoryTypeProperties(m_vma_allocator, memory_type, &flags);
+        return flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+    }
+
+    MemoryStats Context::GetMemoryStats() const {
+        MemoryStats stats{};
+
+        const VkPhysicalDeviceMemoryProperties *memory_properties;
+        vmaGetMemoryProperties(m_vma_allocator, &memory_properties);
+
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+        vmaGetHeapBudgets(m_vma_allocator, budgets.data());
+
+        stats.heaps.reserve(memory_properties->memoryHeapCount);
+        for (const auto i : Counter(memory_properties->memoryHeapCount)) {
+            stats.heaps.emplace_back(MemoryHeapStats{
+                .budget = budgets[i].budget,
+                .usage = budgets[i].usage,
+                .allocation_bytes = budgets[i].statistics.allocationBytes,
+                .block_bytes = budgets[i].statistics.blockBytes,
+                .allocation_count = budgets[i].statistics.allocationCount,
+                .device_local = bool(memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT),
+            });
+        }
+
+        stats.categories = m_memory_categories;
+
+        for (const auto& [key, pool] : m_memory_pools) {
+            VmaStatistics pool_statistics;
+            vmaGetPoolStatistics(m_vma_allocator, pool, &pool_statistics);
+
+            auto& pool_stats = stats.pools[static_cast<size_t>(key.first)];
+            pool_stats.block_bytes += pool_statistics.blockBytes;
+            pool_stats.allocation_bytes += pool_statistics.allocationBytes;
+            pool_stats.block_count += pool_statistics.blockCount;
+            pool_stats.allocation_count += pool_statistics.allocationCount;
+        }
+        stats.staging_high_water_mark = m_staging_ring->GetHighWaterMark();
+        stats.readback_high_water_mark = m_readback_ring->GetHighWaterMark();
+        stats.lazily_allocated_bytes = m_lazily_allocated_bytes;
+        stats.aliased_attachment_bytes = m_transient_attachment_pool->GetAliasedBytes();
+
+        return stats;
+    }
+
     void Context::CreateSwapchain(Uint2 extent, bool Vsync) {
         m_swapchain_properties = GetSupportedSwapchainProperties(m_physical_device, m_surface, extent, Vsync).or_else(
             [this] (auto error_str) -> std::expected<SwapchainProperties, std::string> {
@@ -650,49 +1319,196 @@ namespace DnmGL::Vulkan {
                 MessageType::eGraphicsBackendInternal);
     }
     
-    void Context::CreatePipelineCache() {
-        m_pipeline_cache = m_device.createPipelineCache({});
+    void Context::CreatePipelineCache(const std::filesystem::path& path) {
+        m_pipeline_cache_path = path;
+
+        std::vector<uint8_t> initial_data{};
+        if (!path.empty()) {
+            auto data = LoadPipelineCacheFile(path, m_physical_device.getProperties());
+            if (data) initial_data = std::move(*data);
+            else Message(std::format("pipeline cache is ignored: {}", data.error()), MessageType::eWarning);
+        }
+
+        vk::PipelineCacheCreateInfo create_info{};
+        create_info.setInitialDataSize(initial_data.size())
+                    .setPInitialData(initial_data.data())
+                    ;
+
+        m_pipeline_cache = m_device.createPipelineCache(create_info);
+    }
+
+    bool Context::SavePipelineCache() {
+        if (m_pipeline_cache_path.empty() || !m_pipeline_cache) return false;
+
+        const auto data = m_device.getPipelineCacheData(m_pipeline_cache);
+        const auto header = MakePipelineCacheFileHeader(m_physical_device.getProperties(), data);
+
+        // written to temporary file first, so failed save does not corrupt the old cache
+        auto temp_path = m_pipeline_cache_path;
+        temp_path += ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!file) {
+                Message(std::format("failed to write pipeline cache to {}", temp_path.string()), MessageType::eWarning);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temp_path, m_pipeline_cache_path, error);
+        if (error) {
+            Message(std::format("failed to write pipeline cache to {}: {}", m_pipeline_cache_path.string(), error.message()), MessageType::eWarning);
+            return false;
+        }
+
+        return true;
+    }
+
+    void Context::LoadPipelineManifest(const std::filesystem::path& path) {
+        m_pipeline_manifest_path = path;
+        if (path.empty()) return;
+
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file) return;
+
+        const auto file_size = static_cast<uint64_t>(file.tellg());
+        PipelineManifestFileHeader header{};
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file 
+            || header.magic != PipelineManifestMagic 
+            || header.entry_count != (file_size - sizeof(header)) / sizeof(PipelineManifestEntry)) {
+            Message(std::format("pipeline manifest is ignored: invalid file {}", path.string()), MessageType::eWarning);
+            return;
+        }
+
+        std::vector<PipelineManifestEntry> entries(header.entry_count);
+        file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(PipelineManifestEntry));
+
+        for (const auto& entry : entries) {
+            m_pipeline_manifest.emplace(entry.pipeline_key, entry.attachment_ops);
+        }
+    }
+
+    bool Context::SavePipelineManifest() {
+        if (m_pipeline_manifest_path.empty()) return false;
+
+        std::vector<PipelineManifestEntry> entries;
+        {
+            std::lock_guard lock(m_pipeline_manifest_mutex);
+            entries.reserve(m_pipeline_manifest.size());
+            for (const auto [pipeline_key, attachment_ops] : m_pipeline_manifest) {
+                entries.emplace_back(pipeline_key, attachment_ops);
+            }
+        }
+
+        const PipelineManifestFileHeader header{
+            .magic = PipelineManifestMagic,
+            .entry_count = static_cast<uint32_t>(entries.size()),
+        };
+
+        std::ofstream file(m_pipeline_manifest_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PipelineManifestEntry));
+        if (!file) {
+            Message(std::format("failed to write pipeline manifest to {}", m_pipeline_manifest_path.string()), MessageType::eWarning);
+            return false;
+        }
+
+        return true;
+    }
+
+    void Context::RecordPipelineVariant(uint64_t pipeline_key, uint32_t packed_attachment_ops) {
+        if (!m_record_pipeline_manifest) return;
+
+        std::lock_guard lock(m_pipeline_manifest_mutex);
+        m_pipeline_manifest.emplace(pipeline_key, packed_attachment_ops);
+    }
+
+    void Context::WarmUpPipelines(std::span<DnmGL::GraphicsPipeline* const> input_pipelines) {
+        // dynamic rendering pipelines have no attachment op variants
+        if (GetSupportedFeatures().dynamic_rendering || input_pipelines.empty()) return;
+
+        // variant maps of a pipeline are not synchronized, so every pipeline is given to one worker
+        std::vector<DnmGL::GraphicsPipeline *> pipelines(input_pipelines.begin(), input_pipelines.end());
+        std::ranges::sort(pipelines);
+        const auto duplicates = std::ranges::unique(pipelines);
+        pipelines.erase(duplicates.begin(), duplicates.end());
+
+        // variants are collected first, workers only touch their own pipeline
+        std::vector<std::vector<uint32_t>> variants(pipelines.size());
+        {
+            std::lock_guard lock(m_pipeline_manifest_mutex);
+            for (const auto i : Counter(pipelines.size())) {
+                const auto pipeline_key = static_cast<Vulkan::GraphicsPipelineDefaultVk *>(pipelines[i])->GetManifestKey();
+                for (auto it = m_pipeline_manifest.lower_bound({pipeline_key, 0}); 
+                    it != m_pipeline_manifest.end() && it->first == pipeline_key; ++it) {
+                    variants[i].emplace_back(it->second);
+                }
+            }
+        }
+
+        std::atomic<size_t> next_pipeline{};
+        const auto worker = [&] {
+            for (auto i = next_pipeline++; i < pipelines.size(); i = next_pipeline++) {
+                static_cast<Vulkan::GraphicsPipelineDefaultVk *>(pipelines[i])->WarmUp(variants[i]);
+            }
+        };
+
+        const auto thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, pipelines.size());
+        std::vector<std::jthread> threads;
+        threads.reserve(thread_count - 1);
+        for ([[maybe_unused]] const auto _ : Counter(thread_count - 1)) {
+            threads.emplace_back(worker);
+        }
+        worker();
     }
 
-    void Context::ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func) {
-        [[maybe_unused]] auto _ = m_device.waitForFences(m_fence, vk::True, 1'000'000'000);
-        m_device.resetFences(m_fence);
+    uint64_t Context::ExecuteCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets) {
+        auto& frame = m_frames[GetFrameIndex()];
+        WaitForFrame(frame);
 
-        ProcessResourceUpdates();
         DeleteVulkanObjects();
 
-        m_device.resetCommandPool(m_command_pool);
-        m_command_buffer->command_buffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+        ResetCommandPools(frame);
+        m_transient_uniform_offset = 0;
+        // budget of VK_EXT_memory_budget is refreshed per frame index
+        vmaSetCurrentFrameIndex(m_vma_allocator, static_cast<uint32_t>(m_frame_count));
+        frame.command_buffer->command_buffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
         context_state = ContextState::eCommandBufferRecording;
-        if (!func(m_command_buffer)) {
-            m_command_buffer->End();
-            return;
+        RecordFrameUploads(*frame.command_buffer);
+        if (!func(frame.command_buffer)) {
+            frame.command_buffer->End();
+            context_state = ContextState::eCommandExecuting;
+            return 0;
         }
-        m_command_buffer->End();
+        // copies of the prepared defragmentation pass follow commands of the frame
+        m_defragmenter->RecordPass(*frame.command_buffer);
+        frame.command_buffer->End();
     
-        const vk::SubmitInfo submit_info(
-            {},
-            {},
-            {},
-            1,
-            &m_command_buffer->command_buffer,
-            0,
-            nullptr,
-            {}
-        );
-
-        m_queue.submit({submit_info}, m_fence);
+        const auto ticket = Submit(frame, wait_tickets, false);
         context_state = ContextState::eCommandExecuting;
+        // streamed mips become resident only if their upload is submitted
+        m_texture_streamer->Commit();
+        return ticket;
     }
 
-    void Context::Render(const std::function<bool(DnmGL::CommandBuffer*)>& func) {
-        [[maybe_unused]] auto _ = m_device.waitForFences(m_fence, vk::True, 1'000'000'000);
-        m_device.resetFences(m_fence);
+    uint64_t Context::Render(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets) {
+        if (IsHeadless()) {
+            Message("headless context cannot present, use ExecuteCommands", MessageType::eInvalidBehavior);
+            return 0;
+        }
+
+        auto& frame = m_frames[GetFrameIndex()];
+        WaitForFrame(frame);
 
         //get the next image
         {
             const auto result 
-                = m_device.acquireNextImageKHR(m_swapchain, 1'000'000'000, m_acquire_next_image_semaphore, nullptr);
+                = m_device.acquireNextImageKHR(m_swapchain, 1'000'000'000, frame.acquire_next_image_semaphore, nullptr);
 
             if (result.result == vk::Result::eErrorDeviceLost) {
                 // TODO: make better log
@@ -710,40 +1526,31 @@ namespace DnmGL::Vulkan {
             m_image_index = result.value;
         }
 
-        ProcessResourceUpdates();
         DeleteVulkanObjects();
 
         {
-            m_device.resetCommandPool(m_command_pool);
-            m_command_buffer->command_buffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
-            context_state = ContextState::eCommandBufferRecording;
-            if (!func(m_command_buffer)) {
-                m_command_buffer->End();
-                return;
+            ResetCommandPools(frame);
+            m_transient_uniform_offset = 0;
+            vmaSetCurrentFrameIndex(m_vma_allocator, static_cast<uint32_t>(m_frame_count));
+            frame.command_buffer->command_buffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+                context_state = ContextState::eCommandBufferRecording;
+            RecordFrameUploads(*frame.command_buffer);
+            if (!func(frame.command_buffer)) {
+                frame.command_buffer->End();
+                context_state = ContextState::eCommandExecuting;
+                return 0;
             }
-            m_command_buffer->End();
-
-            constexpr vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-        
-            const vk::SubmitInfo submit_info(
-                1,
-                &m_acquire_next_image_semaphore,
-                &wait_stage,
-                1,
-                &m_command_buffer->command_buffer,
-                1,
-                &m_render_finished_semaphore,
-                {}
-            );
-        
-            m_queue.submit({submit_info}, m_fence);
+            m_defragmenter->RecordPass(*frame.command_buffer);
+            frame.command_buffer->End();
         }
 
+        const auto ticket = Submit(frame, wait_tickets, true);
+
         //Present image
         {
             const vk::PresentInfoKHR present_info(
                 1,
-                &m_render_finished_semaphore,
+                &frame.render_finished_semaphore,
                 1,
                 &m_swapchain,
                 &m_image_index
@@ -765,35 +1572,301 @@ namespace DnmGL::Vulkan {
             }
         }
         context_state = ContextState::eCommandExecuting;
+        m_texture_streamer->Commit();
+        return ticket;
     }
 
-    void Context::ProcessResourceUpdates() {
-        std::vector<vk::WriteDescriptorSet> writes{};
-        std::vector<vk::DescriptorImageInfo> image_infos{};
-        std::vector<vk::DescriptorBufferInfo> buffer_infos{};
+    uint64_t Context::Submit(FrameData& frame, std::span<const uint64_t> wait_tickets, bool presenting) {
+        const auto ticket = m_frame_count + 1;
 
-        writes.reserve(defer_resource_update.size());
-        image_infos.reserve(defer_resource_update.size());
-        buffer_infos.reserve(defer_resource_update.size());
+        std::vector<vk::Semaphore> wait_semaphores{};
+        std::vector<vk::PipelineStageFlags> wait_stages{};
+        std::vector<uint64_t> wait_values{};
 
-        for (const auto& descriptor : defer_resource_update) {
-            std::visit([&writes, &image_infos, &buffer_infos, this] (auto&& res) {
-                using T = std::decay_t<decltype(res)>;
-                if constexpr (std::is_same_v<T, InternalBufferResource>) {
-                    ProcessResource(res, buffer_infos.emplace_back(), writes.emplace_back());
-                }
-                else if constexpr (std::is_same_v<T, InternalImageResource>) {
-                    ProcessResource(res, image_infos.emplace_back(), writes.emplace_back());
-                }
-                else if constexpr (std::is_same_v<T, InternalSamplerResource>) {
-                    ProcessResource(res, image_infos.emplace_back(), writes.emplace_back());
-                }
-            }, descriptor);
+        std::array<vk::Semaphore, 2> signal_semaphores{};
+        std::array<uint64_t, 2> signal_values{};
+        uint32_t signal_count{};
+
+        if (presenting) {
+            wait_semaphores.emplace_back(frame.acquire_next_image_semaphore);
+            wait_stages.emplace_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+            wait_values.emplace_back(0);
+            signal_semaphores[signal_count++] = frame.render_finished_semaphore;
         }
 
-        m_device.updateDescriptorSets(writes, {});
+        AddTicketWaits(wait_tickets, wait_semaphores, wait_stages, wait_values);
+
+        if (supported_features.timeline_semaphore) {
+            signal_semaphores[signal_count] = m_timeline_semaphore;
+            signal_values[signal_count++] = ticket;
+        }
+
+        // hand off uploads, resources are acquired at the begin of this command buffer
+        if (m_transfer.timeline_semaphore) {
+            if (m_transfer.submit_count > m_transfer_handoff_count) {
+                wait_semaphores.emplace_back(m_transfer.timeline_semaphore);
+                wait_stages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+                wait_values.emplace_back(m_transfer.submit_count);
+            }
+        }
+        else {
+            for (const auto semaphore : m_pending_handoff_semaphores) {
+                wait_semaphores.emplace_back(semaphore);
+                wait_stages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+                wait_values.emplace_back(0);
+                // deleted after this frame is completed
+                DeleteObject(semaphore);
+            }
+            m_pending_handoff_semaphores.clear();
+        }
+
+        vk::TimelineSemaphoreSubmitInfoKHR timeline_info{};
+        timeline_info.setWaitSemaphoreValues(wait_values)
+                    .setSignalSemaphoreValueCount(signal_count)
+                    .setPSignalSemaphoreValues(signal_values.data())
+                    ;
+
+        vk::SubmitInfo submit_info{};
+        submit_info.setWaitSemaphores(wait_semaphores)
+                    .setWaitDstStageMask(wait_stages)
+                    .setCommandBuffers(frame.command_buffer->command_buffer)
+                    .setSignalSemaphoreCount(signal_count)
+                    .setPSignalSemaphores(signal_semaphores.data())
+                    ;
 
-        defer_resource_update.clear();
+        if (supported_features.timeline_semaphore) submit_info.setPNext(&timeline_info);
+
+        m_device.resetFences(frame.fence);
+        m_queue.submit({submit_info}, frame.fence);
+        EndFrame(frame);
+
+        m_transfer_handoff_count = m_transfer.submit_count;
+
+        return ticket;
+    }
+
+    uint64_t Context::ExecuteUploadCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets) {
+        if (context_state == ContextState::eCommandBufferRecording) {
+            Message("ExecuteUploadCommands cannot be called while recording commands", MessageType::eInvalidBehavior);
+            return 0;
+        }
+
+        auto& frame = m_transfer.frames[m_transfer.submit_count % m_transfer.frames.size()];
+        WaitForFrame(m_transfer, frame);
+
+        m_device.resetCommandPool(frame.command_pool);
+        frame.command_buffer->command_buffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+        m_transfer.recording = true;
+        const bool submit = func(frame.command_buffer);
+        frame.command_buffer->End();
+        m_transfer.recording = false;
+
+        if (!submit) return 0;
+
+        // without timeline semaphore every upload is handed off with a binary semaphore
+        vk::Semaphore handoff_semaphore = VK_NULL_HANDLE;
+        if (!supported_features.timeline_semaphore)
+            handoff_semaphore = m_pending_handoff_semaphores.emplace_back(m_device.createSemaphore({}));
+
+        return MakeTicket(QueueType::eTransfer, Submit(m_transfer, frame, wait_tickets, handoff_semaphore));
+    }
+
+    uint64_t Context::ExecuteComputeCommands(const std::function<bool(DnmGL::CommandBuffer*)>& func, std::span<const uint64_t> wait_tickets) {
+        if (context_state == ContextState::eCommandBufferRecording) {
+            Message("ExecuteComputeCommands cannot be called while recording commands", MessageType::eInvalidBehavior);
+            return 0;
+        }
+
+        auto& frame = m_compute.frames[m_compute.submit_count % m_compute.frames.size()];
+        WaitForFrame(m_compute, frame);
+
+        m_device.resetCommandPool(frame.command_pool);
+        frame.command_buffer->command_buffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+        m_compute.recording = true;
+        const bool submit = func(frame.command_buffer);
+        frame.command_buffer->End();
+        m_compute.recording = false;
+
+        if (!submit) return 0;
+
+        return MakeTicket(QueueType::eCompute, Submit(m_compute, frame, wait_tickets, VK_NULL_HANDLE));
+    }
+
+    uint64_t Context::Submit(QueueData& queue, FrameData& frame, std::span<const uint64_t> wait_tickets, vk::Semaphore signal_semaphore) {
+        const auto value = queue.submit_count + 1;
+
+        std::vector<vk::Semaphore> wait_semaphores{};
+        std::vector<vk::PipelineStageFlags> wait_stages{};
+        std::vector<uint64_t> wait_values{};
+        AddTicketWaits(wait_tickets, wait_semaphores, wait_stages, wait_values);
+
+        if (queue.timeline_semaphore) signal_semaphore = queue.timeline_semaphore;
+
+        vk::TimelineSemaphoreSubmitInfoKHR timeline_info{};
+        timeline_info.setWaitSemaphoreValues(wait_values)
+                    .setSignalSemaphoreValueCount(1)
+                    .setPSignalSemaphoreValues(&value)
+                    ;
+
+        vk::SubmitInfo submit_info{};
+        submit_info.setWaitSemaphores(wait_semaphores)
+                    .setWaitDstStageMask(wait_stages)
+                    .setCommandBuffers(frame.command_buffer->command_buffer)
+                    .setSignalSemaphoreCount(signal_semaphore ? 1 : 0)
+                    .setPSignalSemaphores(&signal_semaphore)
+                    ;
+
+        if (queue.timeline_semaphore) submit_info.setPNext(&timeline_info);
+
+        m_device.resetFences(frame.fence);
+        queue.queue.submit({submit_info}, frame.fence);
+        frame.submitted_frame_count = ++queue.submit_count;
+
+        return value;
+    }
+
+    void Context::AddTicketWaits(
+        std::span<const uint64_t> wait_tickets, 
+        std::vector<vk::Semaphore>& wait_semaphores, 
+        std::vector<vk::PipelineStageFlags>& wait_stages, 
+        std::vector<uint64_t>& wait_values) {
+        uint64_t max_values[3]{};
+        for (const auto ticket : wait_tickets) {
+            auto& max_value = max_values[static_cast<uint32_t>(GetTicketQueue(ticket))];
+            max_value = std::max(max_value, GetTicketValue(ticket));
+        }
+
+        const auto add_wait = [&] (vk::Semaphore semaphore, uint64_t value) {
+            wait_semaphores.emplace_back(semaphore);
+            wait_stages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+            wait_values.emplace_back(value);
+        };
+
+        if (!supported_features.timeline_semaphore) {
+            // no timeline semaphore, wait on cpu
+            for (const auto queue_type : {QueueType::eGraphics, QueueType::eTransfer, QueueType::eCompute}) {
+                if (const auto value = max_values[static_cast<uint32_t>(queue_type)]) 
+                    Wait(MakeTicket(queue_type, value));
+            }
+            return;
+        }
+
+        if (const auto value = max_values[static_cast<uint32_t>(QueueType::eGraphics)]; value > m_completed_frame_count) 
+            add_wait(m_timeline_semaphore, value);
+        if (const auto value = max_values[static_cast<uint32_t>(QueueType::eTransfer)]; value > m_transfer.completed_count) 
+            add_wait(m_transfer.timeline_semaphore, value);
+        if (const auto value = max_values[static_cast<uint32_t>(QueueType::eCompute)]; value > m_compute.completed_count) 
+            add_wait(m_compute.timeline_semaphore, value);
+    }
+
+    bool Context::IsComplete(uint64_t ticket) noexcept {
+        if (GetTicketQueue(ticket) == QueueType::eTransfer) 
+            return IsComplete(m_transfer, GetTicketValue(ticket));
+        if (GetTicketQueue(ticket) == QueueType::eCompute) 
+            return IsComplete(m_compute, GetTicketValue(ticket));
+
+        if (ticket <= m_completed_frame_count) return true;
+        if (ticket > m_frame_count) return false;
+
+        if (supported_features.timeline_semaphore) {
+            const auto value = m_device.getSemaphoreCounterValueKHR(m_timeline_semaphore, dispatcher);
+            m_completed_frame_count = std::max(m_completed_frame_count, value);
+        }
+        else {
+            // ticket's ring slot cannot be reused before the ticket completed
+            const auto& frame = m_frames[(ticket - 1) % m_frames.size()];
+            if (m_device.getFenceStatus(frame.fence) == vk::Result::eSuccess)
+                m_completed_frame_count = std::max(m_completed_frame_count, frame.submitted_frame_count);
+        }
+
+        return ticket <= m_completed_frame_count;
+    }
+
+    bool Context::Wait(uint64_t ticket, uint64_t timeout) {
+        if (GetTicketQueue(ticket) == QueueType::eTransfer) 
+            return Wait(m_transfer, GetTicketValue(ticket), timeout);
+        if (GetTicketQueue(ticket) == QueueType::eCompute) 
+            return Wait(m_compute, GetTicketValue(ticket), timeout);
+
+        if (IsComplete(ticket)) return true;
+
+        if (ticket > m_frame_count) {
+            Message(std::format("ticket {} is not submitted yet", ticket), MessageType::eInvalidBehavior);
+            return false;
+        }
+
+        if (supported_features.timeline_semaphore) {
+            vk::SemaphoreWaitInfoKHR wait_info{};
+            wait_info.setSemaphores(m_timeline_semaphore)
+                    .setValues(ticket);
+
+            if (m_device.waitSemaphoresKHR(wait_info, timeout, dispatcher) != vk::Result::eSuccess)
+                return false;
+
+            m_completed_frame_count = std::max(m_completed_frame_count, ticket);
+        }
+        else {
+            const auto& frame = m_frames[(ticket - 1) % m_frames.size()];
+            if (m_device.waitForFences(frame.fence, vk::True, timeout) != vk::Result::eSuccess)
+                return false;
+
+            m_completed_frame_count = std::max(m_completed_frame_count, frame.submitted_frame_count);
+        }
+        return true;
+    }
+
+    bool Context::IsComplete(QueueData& queue, uint64_t value) noexcept {
+        if (value <= queue.completed_count) return true;
+        if (value > queue.submit_count) return false;
+
+        if (queue.timeline_semaphore) {
+            const auto completed_value = m_device.getSemaphoreCounterValueKHR(queue.timeline_semaphore, dispatcher);
+            queue.completed_count = std::max(queue.completed_count, completed_value);
+        }
+        else {
+            const auto& frame = queue.frames[(value - 1) % queue.frames.size()];
+            if (m_device.getFenceStatus(frame.fence) == vk::Result::eSuccess)
+                queue.completed_count = std::max(queue.completed_count, frame.submitted_frame_count);
+        }
+
+        return value <= queue.completed_count;
+    }
+
+    bool Context::Wait(QueueData& queue, uint64_t value, uint64_t timeout) {
+        if (IsComplete(queue, value)) return true;
+
+        if (value > queue.submit_count) {
+            Message(std::format("ticket {} is not submitted yet", value), MessageType::eInvalidBehavior);
+            return false;
+        }
+
+        if (queue.timeline_semaphore) {
+            vk::SemaphoreWaitInfoKHR wait_info{};
+            wait_info.setSemaphores(queue.timeline_semaphore)
+                    .setValues(value);
+
+            if (m_device.waitSemaphoresKHR(wait_info, timeout, dispatcher) != vk::Result::eSuccess)
+                return false;
+
+            queue.completed_count = std::max(queue.completed_count, value);
+        }
+        else {
+            const auto& frame = queue.frames[(value - 1) % queue.frames.size()];
+            if (m_device.waitForFences(frame.fence, vk::True, timeout) != vk::Result::eSuccess)
+                return false;
+
+            queue.completed_count = std::max(queue.completed_count, frame.submitted_frame_count);
+        }
+        return true;
+    }
+
+    void Context::EndFrame(FrameData& frame) {
+        frame.submitted_frame_count = ++m_frame_count;
+
+        // images waiting layout restore are moved to the next frame's command buffer
+        auto& next_frame = m_frames[GetFrameIndex()];
+        if (&next_frame != &frame)
+            next_frame.command_buffer->m_pending_layout_restore_images.merge(frame.command_buffer->m_pending_layout_restore_images);
     }
 
     void Context::CreateResource() {
@@ -818,14 +1891,16 @@ namespace DnmGL::Vulkan {
                 .mipmap_levels = 1,
             });
 
-            CreateDepthBuffer(
-                m_swapchain_settings.window_extent, 
-                m_swapchain_settings.msaa, 
-                m_swapchain_settings.depth_buffer_format);
+            if (!IsHeadless()) {
+                CreateDepthBuffer(
+                    m_swapchain_settings.window_extent, 
+                    m_swapchain_settings.msaa, 
+                    m_swapchain_settings.depth_buffer_format);
 
-            CreateResolveImage(
-                m_swapchain_settings.window_extent, 
-                m_swapchain_settings.msaa);
+                CreateResolveImage(
+                    m_swapchain_settings.window_extent, 
+                    m_swapchain_settings.msaa);
+            }
 
             const uint32_t pixel_data = -1;
             typed_command_buffer->UploadData<uint32_t>(
@@ -861,6 +1936,9 @@ namespace DnmGL::Vulkan {
 
         m_swapchain_settings = new_settings;
 
+        if (IsHeadless())
+            return;
+
         if (!(Vsync_change || extent_change || msaa_change || depth_format_change))
             return;
 
@@ -952,10 +2030,25 @@ namespace DnmGL::Vulkan {
         return std::make_unique<DnmGL::Vulkan::Buffer>(*this, desc);
     }
 
+    std::unique_ptr<DnmGL::Buffer> Context::CreateBufferFromHostPointer(const DnmGL::BufferDesc& desc, void *host_pointer) noexcept {
+        return std::make_unique<DnmGL::Vulkan::Buffer>(*this, desc, host_pointer);
+    }
+
     std::unique_ptr<DnmGL::Image> Context::CreateImage(const DnmGL::ImageDesc& desc) noexcept {
         return std::make_unique<DnmGL::Vulkan::Image>(*this, desc);
     }
 
+    std::unique_ptr<DnmGL::Image> Context::CreateStreamingImage(DnmGL::StreamingImageDesc&& desc) noexcept {
+        if (desc.mip_data.size() != desc.image_desc.mipmap_levels) {
+            Message("StreamingImageDesc::mip_data size must be equal to mipmap_levels", MessageType::eInvalidBehavior);
+            return nullptr;
+        }
+
+        auto image = std::make_unique<DnmGL::Vulkan::Image>(*this, desc.image_desc);
+        if (!m_texture_streamer->Add(image.get(), std::move(desc.mip_data))) return nullptr;
+        return image;
+    }
+
     std::unique_ptr<DnmGL::Sampler> Context::CreateSampler(const DnmGL::SamplerDesc& desc) noexcept {
         return std::make_unique<DnmGL::Vulkan::Sampler>(*this, desc);
     }
@@ -0,0 +1,335 @@
+#include "DnmGL/Vulkan/Defragmenter.hpp"
+#include "DnmGL/Vulkan/CommandBuffer.hpp"
+#include "DnmGL/Vulkan/Buffer.hpp"
+#include "DnmGL/Vulkan/Image.hpp"
+
+#include <chrono>
+
+namespace DnmGL::Vulkan {
+    Defragmenter::~Defragmenter() {
+        // gpu is idle, moves that are not recorded are dropped
+        if (m_pass_pending) {
+            for (const auto& move : m_moves) {
+                if (move.buffer) m_context->GetDevice().destroy(move.new_buffer);
+                else m_context->GetDevice().destroy(move.new_image);
+                move.vma_move->operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            }
+            vmaEndDefragmentationPass(m_context->GetVmaAllocator(), m_defragmentation, &m_pass);
+        }
+        if (m_defragmentation) vmaEndDefragmentation(m_context->GetVmaAllocator(), m_defragmentation, nullptr);
+    }
+
+    bool Defragmenter::BeginPass(const DefragmentationDesc& desc, DefragmentationStats& stats) {
+        if (m_pass_pending) return false;
+
+        if (!m_defragmentation) {
+            // a cycle compacts default pools first, then every custom pool
+            if (m_pending_pools.empty()) {
+                for (const auto pool : m_context->GetMemoryPools() | std::views::values)
+                    m_pending_pools.emplace_back(pool);
+                m_pending_pools.emplace_back(VK_NULL_HANDLE);
+            }
+
+            Begin(desc, m_pending_pools.back());
+            m_pending_pools.pop_back();
+            if (!m_defragmentation) return false;
+        }
+
+        m_pass = {};
+        const auto result = (vk::Result)vmaBeginDefragmentationPass(m_context->GetVmaAllocator(), m_defragmentation, &m_pass);
+        if (result == vk::Result::eSuccess) {
+            End(stats);
+            return false;
+        }
+        if (result != vk::Result::eIncomplete) {
+            m_context->Message("vmaBeginDefragmentationPass failed", MessageType::eUnknown);
+            End(stats);
+            return false;
+        }
+
+        m_moves.clear();
+        const auto begin_time = std::chrono::steady_clock::now();
+        for (const auto i : Counter(m_pass.moveCount)) {
+            // moves over the time budget are left to the next passes
+            if (desc.max_microseconds_per_pass 
+            && std::chrono::steady_clock::now() - begin_time >= std::chrono::microseconds(desc.max_microseconds_per_pass)) {
+                m_pass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+            PrepareMove(m_pass.pMoves[i]);
+        }
+
+        if (m_moves.empty()) {
+            // every move is ignored, nothing to copy
+            if (vmaEndDefragmentationPass(m_context->GetVmaAllocator(), m_defragmentation, &m_pass) == VK_SUCCESS)
+                End(stats);
+            return false;
+        }
+
+        m_pass_pending = true;
+        return true;
+    }
+
+    void Defragmenter::RecordPass(Vulkan::CommandBuffer& command_buffer) {
+        if (!m_pass_pending || m_pass_recorded) return;
+
+        // moves may be dropped by destroyed resources
+        if (!m_moves.empty()) {
+            RecordCopies(command_buffer.command_buffer);
+            SwapHandles();
+        }
+
+        m_pass_recorded = true;
+        m_pass_tag = m_context->GetSubmissionTag();
+    }
+
+    bool Defragmenter::EndPass(DefragmentationStats& stats) {
+        if (!m_pass_pending) return true;
+        if (!m_pass_recorded) return false;
+
+        m_context->UpdateCompletedCounts();
+        if (!m_context->IsComplete(m_pass_tag)) return false;
+
+        // allocations of destroyed resources are freed by vmaEndDefragmentationPass
+        for (const auto i : Counter(m_pass.moveCount)) {
+            if (m_pass.pMoves[i].operation == VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY)
+                m_context->UntrackAllocation(m_pass.pMoves[i].srcAllocation);
+        }
+
+        // old memory is not used by any submission anymore
+        const auto result = vmaEndDefragmentationPass(m_context->GetVmaAllocator(), m_defragmentation, &m_pass);
+        m_pass_pending = false;
+        m_pass_recorded = false;
+
+        stats.bytes_moved += std::exchange(m_bytes_moved, 0);
+        stats.allocations_moved += std::exchange(m_allocations_moved, 0);
+        if (result == VK_SUCCESS) End(stats);
+        return true;
+    }
+
+    bool Defragmenter::Remove(VmaAllocation allocation) {
+        m_owners.erase(allocation);
+        if (!m_pass_pending) return false;
+
+        // ignored moves are destroyed too, vma still uses their source allocation at the end of the pass
+        const auto moves = std::span(m_pass.pMoves, m_pass.moveCount);
+        const auto vma_move = std::ranges::find_if(moves, [allocation] (const auto& move) {
+            return move.srcAllocation == allocation && move.operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+        });
+        if (vma_move == moves.end()) return false;
+
+        vma_move->operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+        if (m_pass_recorded) {
+            // memory is freed after the last submission of the owner
+            m_pass_tag = m_context->GetSubmissionTag();
+            return true;
+        }
+
+        // new handle is never used by gpu
+        if (const auto it = std::ranges::find(m_moves, &*vma_move, &Move::vma_move); it != m_moves.end()) {
+            if (it->buffer) m_context->GetDevice().destroy(it->new_buffer);
+            else m_context->GetDevice().destroy(it->new_image);
+            m_moves.erase(it);
+        }
+        return true;
+    }
+
+    void Defragmenter::Begin(const DefragmentationDesc& desc, VmaPool pool) {
+        VmaDefragmentationInfo info{};
+        info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        info.pool = pool;
+        info.maxBytesPerPass = desc.max_bytes_per_pass;
+        info.maxAllocationsPerPass = desc.max_allocations_per_pass;
+
+        if (vmaBeginDefragmentation(m_context->GetVmaAllocator(), &info, &m_defragmentation) != VK_SUCCESS) {
+            m_context->Message("vmaBeginDefragmentation failed", MessageType::eUnknown);
+            m_defragmentation = VK_NULL_HANDLE;
+        }
+    }
+
+    void Defragmenter::End(DefragmentationStats& stats) {
+        VmaDefragmentationStats vma_stats{};
+        vmaEndDefragmentation(m_context->GetVmaAllocator(), m_defragmentation, &vma_stats);
+        m_defragmentation = VK_NULL_HANDLE;
+
+        stats.bytes_freed += vma_stats.bytesFreed;
+        stats.finished = m_pending_pools.empty();
+    }
+
+    void Defragmenter::PrepareMove(VmaDefragmentationMove& move) {
+        const auto allocator = m_context->GetVmaAllocator();
+
+        const auto it = m_owners.find(move.srcAllocation);
+        if (it == m_owners.end()) {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            return;
+        }
+
+        std::visit([&move, allocator, this] (auto&& owner) {
+            using T = std::decay_t<decltype(owner)>;
+            if constexpr (std::is_same_v<T, Vulkan::Buffer*>) {
+                // descriptors of every resource manager point to the transient uniform buffer
+                if (owner == m_context->GetTransientUniformBuffer()) {
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    return;
+                }
+                // host writes to the new memory could be overwritten by the pending copy
+                if (owner->m_mapped_ptr && !owner->m_staging_buffer && !owner->m_host_pointer) {
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    return;
+                }
+
+                const auto create_info = Vulkan::Buffer::GetCreateInfo(*m_context, owner->GetDesc());
+                const auto new_buffer = m_context->GetDevice().createBuffer(reinterpret_cast<const vk::BufferCreateInfo&>(create_info));
+                vmaBindBufferMemory(allocator, move.dstTmpAllocation, new_buffer);
+
+                m_moves.emplace_back(owner, nullptr, new_buffer, nullptr, &move);
+            }
+            else if constexpr (std::is_same_v<T, Vulkan::Image*>) {
+                // layout of images waiting for initial layout translation is not known yet
+                if (owner->m_image_layout == vk::ImageLayout::ePreinitialized 
+                || owner->m_image_layout == vk::ImageLayout::eUndefined) {
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    return;
+                }
+
+                const auto new_image = m_context->GetDevice().createImage(Vulkan::Image::GetCreateInfo(*m_context, owner->GetDesc()));
+                vmaBindImageMemory(allocator, move.dstTmpAllocation, new_image);
+
+                m_moves.emplace_back(nullptr, owner, nullptr, new_image, &move);
+            }
+        }, it->second);
+    }
+
+    void Defragmenter::RecordCopies(vk::CommandBuffer command_buffer) {
+        std::vector<vk::ImageMemoryBarrier> src_barriers{};
+        std::vector<vk::ImageMemoryBarrier> dst_barriers{};
+
+        for (const auto& move : m_moves) {
+            if (!move.image) continue;
+
+            const auto range = vk::ImageSubresourceRange{}
+                    .setAspectMask(move.image->GetAspect())
+                    .setBaseMipLevel(0)
+                    .setLevelCount(vk::RemainingMipLevels)
+                    .setBaseArrayLayer(0)
+                    .setLayerCount(vk::RemainingArrayLayers);
+
+            src_barriers.emplace_back(vk::ImageMemoryBarrier{}
+                    .setImage(move.image->GetImage())
+                    .setOldLayout(move.image->GetImageLayout())
+                    .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+                    .setSrcAccessMask(vk::AccessFlagBits::eMemoryWrite)
+                    .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+                    .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+                    .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+                    .setSubresourceRange(range));
+
+            src_barriers.emplace_back(vk::ImageMemoryBarrier{}
+                    .setImage(move.new_image)
+                    .setOldLayout(vk::ImageLayout::eUndefined)
+                    .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+                    .setSrcAccessMask({})
+                    .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+                    .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+                    .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+                    .setSubresourceRange(range));
+
+            // contents keep the layout of the old image
+            dst_barriers.emplace_back(vk::ImageMemoryBarrier{}
+                    .setImage(move.new_image)
+                    .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+                    .setNewLayout(move.image->GetImageLayout())
+                    .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                    .setDstAccessMask(vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite)
+                    .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+                    .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+                    .setSubresourceRange(range));
+        }
+
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eAllCommands,
+            vk::PipelineStageFlagBits::eTransfer,
+            {},
+            vk::MemoryBarrier(vk::AccessFlagBits::eMemoryWrite, vk::AccessFlagBits::eTransferRead),
+            {},
+            src_barriers);
+
+        for (const auto& move : m_moves) {
+            if (move.buffer) {
+                const auto& desc = move.buffer->GetDesc();
+                command_buffer.copyBuffer(
+                    move.buffer->GetBuffer(), 
+                    move.new_buffer, 
+                    vk::BufferCopy(0, 0, desc.GetSize()));
+                continue;
+            }
+
+            const auto& desc = move.image->GetDesc();
+            const auto create_info = Vulkan::Image::GetCreateInfo(*m_context, desc);
+
+            std::vector<vk::ImageCopy> regions{};
+            regions.reserve(desc.mipmap_levels);
+            for (const auto mip : Counter(desc.mipmap_levels)) {
+                const auto subresource = vk::ImageSubresourceLayers{}
+                        .setAspectMask(move.image->GetAspect())
+                        .setMipLevel(mip)
+                        .setBaseArrayLayer(0)
+                        .setLayerCount(create_info.arrayLayers);
+
+                regions.emplace_back(
+                    subresource, vk::Offset3D{}, 
+                    subresource, vk::Offset3D{}, 
+                    vk::Extent3D(
+                        std::max(create_info.extent.width >> mip, 1u),
+                        std::max(create_info.extent.height >> mip, 1u),
+                        std::max(create_info.extent.depth >> mip, 1u)));
+            }
+
+            command_buffer.copyImage(
+                move.image->GetImage(), vk::ImageLayout::eTransferSrcOptimal, 
+                move.new_image, vk::ImageLayout::eTransferDstOptimal, 
+                regions);
+        }
+
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eAllCommands,
+            {},
+            vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite),
+            {},
+            dst_barriers);
+    }
+
+    void Defragmenter::SwapHandles() {
+        std::unordered_set<const void *> moved_resources{};
+
+        // frames in flight may still use old handles, new handles are bound to dstTmpAllocation until the pass ends
+        for (const auto& move : m_moves) {
+            VmaAllocationInfo alloc_info;
+            vmaGetAllocationInfo(m_context->GetVmaAllocator(), move.vma_move->srcAllocation, &alloc_info);
+
+            if (move.buffer) {
+                m_context->DeleteObject(move.buffer->m_buffer);
+                move.buffer->m_buffer = move.new_buffer;
+                moved_resources.insert(static_cast<const DnmGL::Buffer*>(move.buffer));
+            }
+            else {
+                // views are created again by RewriteResources
+                for (const auto image_view : move.image->m_image_views | std::views::values)
+                    m_context->DeleteObject(image_view);
+                move.image->m_image_views.clear();
+
+                m_context->DeleteObject(move.image->m_image);
+                move.image->m_image = move.new_image;
+                moved_resources.insert(static_cast<const DnmGL::Image*>(move.image));
+            }
+
+            m_bytes_moved += alloc_info.size;
+            ++m_allocations_moved;
+        }
+
+        m_context->RewriteResources(moved_resources);
+        m_moves.clear();
+    }
+}
@@ -1,5 +1,6 @@
 #include "DnmGL/Vulkan/Framebuffer.hpp"
 #include "DnmGL/Vulkan/ToVkFormat.hpp"
+#include "DnmGL/Vulkan/TransientAttachmentPool.hpp"
 
 namespace DnmGL::Vulkan {
     FramebufferBase::FramebufferBase(Vulkan::Context& ctx, const DnmGL::FramebufferDesc& desc) noexcept 
@@ -11,11 +12,7 @@ namespace DnmGL::Vulkan {
         }
         
         if (m_desc.create_depth_buffer) {
-            m_depth_buffer = CreateResource(
-                        m_desc.extent,
-                        ImageUsageBits::eDepthStencilAttachment | ImageUsageBits::eTransientAttachment, 
-                        m_desc.depth_stencil_format, 
-                        m_desc.msaa);
+            m_depth_buffer = CreateDepthBuffer();
         }
     }
 
@@ -24,6 +21,7 @@ namespace DnmGL::Vulkan {
         m_user_color_attachments.resize(0);
         m_user_depth_stencil_attachment = nullptr;
         m_attachments.clear();
+        m_msaa_color_attachments.clear();
         
         for (const auto i : Counter(color_attachments.size())) {
             auto* typed_image = reinterpret_cast<Vulkan::Image *>(color_attachments[i].image);
@@ -37,7 +35,8 @@ namespace DnmGL::Vulkan {
                         m_desc.extent, 
                         ImageUsageBits::eColorAttachment | ImageUsageBits::eTransientAttachment, 
                         m_desc.color_attachment_formats[i],
-                        m_desc.msaa);
+                        m_desc.msaa,
+                        static_cast<uint32_t>(i));
 
                 m_attachments.emplace_back(image->CreateGetImageView(ImageSubresource{}));
                 m_msaa_color_attachments.emplace_back(std::move(image));
@@ -51,27 +50,28 @@ namespace DnmGL::Vulkan {
             }
             else {
                 if (!m_depth_buffer) {
-                    m_depth_buffer = CreateResource(
-                        m_desc.extent,
-                        ImageUsageBits::eDepthStencilAttachment | ImageUsageBits::eTransientAttachment, 
-                        m_desc.depth_stencil_format, 
-                        m_desc.msaa);
+                    m_depth_buffer = CreateDepthBuffer();
                 }
                 m_attachments.emplace_back(m_depth_buffer->CreateGetImageView({}));
             }
         }
     }
 
-    std::unique_ptr<Vulkan::Image> FramebufferBase::CreateResource(Uint2 extent, ImageUsageFlags usage, DnmGL::ImageFormat format, SampleCount sample_count) noexcept {
-        return std::make_unique<Vulkan::Image>(
-            *VulkanContext, 
-            DnmGL::ImageDesc{
-                .extent = {extent.x, extent.y, 1},
-                .format = format,
-                .usage_flags = usage,
-                .type = ImageType::e2D,
-                .mipmap_levels = 1,
-                .sample_count = sample_count,
-            });
+    std::unique_ptr<Vulkan::Image> FramebufferBase::CreateResource(Uint2 extent, ImageUsageFlags usage, DnmGL::ImageFormat format, SampleCount sample_count, uint32_t slot) noexcept {
+        // msaa images are transient, so they can share memory with the same slot of other framebuffers
+        // memory is made available to the next pass by the aliasing barriers of CommandBuffer::TranslateAttachmentLayouts
+        return VulkanContext->GetTransientAttachmentPool().Acquire(extent, usage, format, sample_count, slot);
+    }
+
+    std::unique_ptr<Vulkan::Image> FramebufferBase::CreateDepthBuffer() noexcept {
+        // depth is often loaded by later passes of the same framebuffer, so it doesn't share memory
+        return std::make_unique<Vulkan::Image>(*VulkanContext, DnmGL::ImageDesc{
+            .extent = {m_desc.extent, 1},
+            .format = m_desc.depth_stencil_format,
+            .usage_flags = ImageUsageBits::eDepthStencilAttachment | ImageUsageBits::eTransientAttachment,
+            .type = ImageType::e2D,
+            .mipmap_levels = 1,
+            .sample_count = m_desc.msaa,
+        });
     }
 }
\ No newline at end of file
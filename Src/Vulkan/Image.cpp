@@ -1,5 +1,8 @@
 #include "DnmGL/Vulkan/Image.hpp"
 #include "DnmGL/Vulkan/CommandBuffer.hpp"
+#include "DnmGL/Vulkan/TransientAttachmentPool.hpp"
+#include "DnmGL/Vulkan/Defragmenter.hpp"
+#include "DnmGL/Vulkan/TextureStreamer.hpp"
 #include "DnmGL/Vulkan/ToVkFormat.hpp"
 
 namespace DnmGL::Vulkan {
@@ -35,63 +38,102 @@ namespace DnmGL::Vulkan {
             return vk_flags;
         }
 
-        vk_flags |= vk::ImageUsageFlagBits::eTransferDst;
+        // defragmentation copies images to their new memory
+        vk_flags |= vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc;
 
         if (usage_flags.Has(ImageUsageBits::eReadonlyResource))
             vk_flags |= vk::ImageUsageFlagBits::eSampled;
         
-        if (usage_flags.Has(ImageUsageBits::eColorAttachment)) {
+        if (usage_flags.Has(ImageUsageBits::eColorAttachment))
             vk_flags |= vk::ImageUsageFlagBits::eColorAttachment;
-            vk_flags |= vk::ImageUsageFlagBits::eTransferSrc;
-        }
 
-        if (usage_flags.Has(ImageUsageBits::eDepthStencilAttachment)) {
+        if (usage_flags.Has(ImageUsageBits::eDepthStencilAttachment))
             vk_flags |= vk::ImageUsageFlagBits::eDepthStencilAttachment;
-            vk_flags |= vk::ImageUsageFlagBits::eTransferSrc;
-        }
 
-        if (usage_flags.Has(ImageUsageBits::eWritebleResource)) {
+        if (usage_flags.Has(ImageUsageBits::eWritebleResource))
             vk_flags |= vk::ImageUsageFlagBits::eStorage;
-            vk_flags |= vk::ImageUsageFlagBits::eTransferSrc;
-        }
 
         return vk_flags;
     }
 
-    Image::Image(Vulkan::Context& ctx, const DnmGL::ImageDesc& desc)
-    : DnmGL::Image(ctx, desc) {
-        {
-            switch (m_desc.format) {
-                case DnmGL::ImageFormat::eD16Norm: 
-                case DnmGL::ImageFormat::eD32Float: m_aspect = vk::ImageAspectFlagBits::eDepth; break;
-                case DnmGL::ImageFormat::eD24NormS8UInt:
-                case DnmGL::ImageFormat::eD32NormS8UInt: m_aspect = vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil; break;
-                default: m_aspect = vk::ImageAspectFlagBits::eColor; break;
-            }
+    static constexpr vk::ImageAspectFlags GetAspect(DnmGL::ImageFormat format) {
+        switch (format) {
+            case DnmGL::ImageFormat::eD16Norm: 
+            case DnmGL::ImageFormat::eD32Float: return vk::ImageAspectFlagBits::eDepth;
+            case DnmGL::ImageFormat::eD24NormS8UInt:
+            case DnmGL::ImageFormat::eD32NormS8UInt: return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+            default: return vk::ImageAspectFlagBits::eColor;
         }
+    }
 
+    vk::ImageCreateInfo Image::GetCreateInfo(Vulkan::Context& context, const DnmGL::ImageDesc& desc) {
         vk::ImageCreateFlags flags{};
-        if (m_desc.type == ImageType::e3D) flags |= vk::ImageCreateFlagBits::e2DArrayCompatible;
-        if (m_desc.type == ImageType::e2D && m_desc.extent.z >= 6) flags |= vk::ImageCreateFlagBits::eCubeCompatible;
+        if (desc.type == ImageType::e3D) flags |= vk::ImageCreateFlagBits::e2DArrayCompatible;
+        if (desc.type == ImageType::e2D && desc.extent.z >= 6) flags |= vk::ImageCreateFlagBits::eCubeCompatible;
 
         vk::ImageCreateInfo create_info{};
         create_info.setInitialLayout(vk::ImageLayout::ePreinitialized)
-                    .setImageType(GetVkImageType(m_desc.type))
-                    .setArrayLayers((m_desc.type == ImageType::e2D) ? m_desc.extent.z : 1u)
-                    .setExtent(vk::Extent3D(m_desc.extent.x, m_desc.extent.y, (m_desc.type == ImageType::e3D) ? 1 : m_desc.extent.z))
+                    .setImageType(GetVkImageType(desc.type))
+                    .setArrayLayers((desc.type == ImageType::e2D) ? desc.extent.z : 1u)
+                    .setExtent(vk::Extent3D(desc.extent.x, desc.extent.y, (desc.type == ImageType::e3D) ? 1 : desc.extent.z))
                     .setFlags(flags)
-                    .setSamples(VulkanContext->GetSampleCount(desc.sample_count, bool(m_aspect & vk::ImageAspectFlagBits::eStencil)))
+                    .setSamples(context.GetSampleCount(desc.sample_count, bool(GetAspect(desc.format) & vk::ImageAspectFlagBits::eStencil)))
                     .setSharingMode(vk::SharingMode::eExclusive)
                     .setTiling(vk::ImageTiling::eOptimal)
-                    .setUsage(GetVkUsageFlags(m_desc.usage_flags))
-                    .setFormat(ToVkFormat(m_desc.format))
-                    .setMipLevels(m_desc.mipmap_levels)
+                    .setUsage(GetVkUsageFlags(desc.usage_flags))
+                    .setFormat(ToVkFormat(desc.format))
+                    .setMipLevels(desc.mipmap_levels)
                     ;
 
+        // span of context member, valid while context is alive
+        if (const auto queue_families = context.GetSharedQueueFamilies(); !queue_families.empty()) {
+            create_info.setSharingMode(vk::SharingMode::eConcurrent)
+                        .setQueueFamilyIndices(queue_families);
+        }
+
+        return create_info;
+    }
+
+    vk::MemoryRequirements Image::GetMemoryRequirements(Vulkan::Context& context, const DnmGL::ImageDesc& desc) {
+        // image is never used, it can be destroyed immediately
+        const auto device = context.GetDevice();
+        const auto image = device.createImage(GetCreateInfo(context, desc));
+        const auto requirements = device.getImageMemoryRequirements(image);
+        device.destroy(image);
+
+        return requirements;
+    }
+
+    Image::Image(Vulkan::Context& ctx, const DnmGL::ImageDesc& desc, VmaAllocation alias_allocation)
+    : DnmGL::Image(ctx, desc), m_aspect(GetAspect(desc.format)), m_alias_allocation(alias_allocation) {
+        auto create_info = GetCreateInfo(*VulkanContext, m_desc);
+
+        if (m_alias_allocation) {
+            CreateAliasingImage(create_info);
+            return;
+        }
+
         VmaAllocationCreateInfo alloc_create_info{};
         alloc_create_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_AUTO;
         alloc_create_info.priority = 1.f;
 
+        // transient attachments are never loaded or stored, tilers keep them in tile memory only
+        const bool lazily_allocated = m_desc.usage_flags.Has(ImageUsageBits::eTransientAttachment)
+                                    && VulkanContext->GetSupportedFeatures().lazily_allocated_memory;
+        const bool is_attachment = m_desc.usage_flags.Has(ImageUsageBits::eColorAttachment) 
+                                || m_desc.usage_flags.Has(ImageUsageBits::eDepthStencilAttachment);
+        if (lazily_allocated) {
+            alloc_create_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            alloc_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        }
+        // textures stay in default pools, their sizes vary too much to share blocks well
+        else if (is_attachment) {
+            VulkanContext->ApplyMemoryPool(MemoryPoolType::eRenderTarget, 
+                GetMemoryRequirements(*VulkanContext, m_desc).size, 
+                reinterpret_cast<const VkImageCreateInfo&>(create_info), 
+                alloc_create_info);
+        }
+
         VmaAllocationInfo alloc_info;
         auto result = (vk::Result)vmaCreateImage(
             VulkanContext->GetVmaAllocator(), 
@@ -101,13 +143,51 @@ namespace DnmGL::Vulkan {
             &m_allocation, 
             &alloc_info);
 
+        // lazily allocated memory type may not support this format, pool block may be full or too small
+        if ((lazily_allocated || alloc_create_info.pool) && result != vk::Result::eSuccess) {
+            alloc_create_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_AUTO;
+            alloc_create_info.flags &= ~VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+            alloc_create_info.pool = VK_NULL_HANDLE;
+
+            result = (vk::Result)vmaCreateImage(
+                VulkanContext->GetVmaAllocator(), 
+                reinterpret_cast<VkImageCreateInfo*>(&create_info), 
+                &alloc_create_info, 
+                reinterpret_cast<VkImage*>(&m_image), 
+                &m_allocation, 
+                &alloc_info);
+        }
+
         if (result == vk::Result::eErrorOutOfDeviceMemory || result == vk::Result::eErrorOutOfHostMemory) {
             VulkanContext->Message("vmaCreateImage create buffer failed, out of memory", MessageType::eOutOfMemory);
         }
         else if (result != vk::Result::eSuccess) {
             VulkanContext->Message("vmaCreateImage create buffer failed, unknown", MessageType::eUnknown);
         }
+        else {
+            VulkanContext->TrackAllocation(m_allocation, is_attachment ? MemoryCategory::eAttachment : MemoryCategory::eImage);
+            // vk::Framebuffer objects keep views of attachments, they are not moved
+            if (!is_attachment) VulkanContext->GetDefragmenter().AddImage(m_allocation, this);
+        }
+
+        TranslateInitialLayout();
+    }
+
+    void Image::CreateAliasingImage(const vk::ImageCreateInfo& create_info) {
+        const auto result = (vk::Result)vmaCreateAliasingImage(
+            VulkanContext->GetVmaAllocator(), 
+            m_alias_allocation, 
+            reinterpret_cast<const VkImageCreateInfo*>(&create_info), 
+            reinterpret_cast<VkImage*>(&m_image));
+
+        if (result != vk::Result::eSuccess) {
+            VulkanContext->Message("vmaCreateAliasingImage create image failed", MessageType::eUnknown);
+        }
+
+        TranslateInitialLayout();
+    }
 
+    void Image::TranslateInitialLayout() {
         auto* command_buffer = VulkanContext->GetCommandBufferIfRecording();
         if (command_buffer && command_buffer->GetPassType() != CommandBufferPassType::eTransfer) {
             const ImageBarrier transfer_layout_desc{
@@ -128,18 +208,25 @@ namespace DnmGL::Vulkan {
     }
 
     Image::~Image() {
-        const auto image = m_image;
-        const auto image_views = std::move(m_image_views);
         VulkanContext->GetCommandBuffer()->RemoveDeferLayoutTranslation(this);
+        VulkanContext->GetTextureStreamer().Remove(this);
+
+        for (auto image_view : m_image_views | std::ranges::views::values)
+            VulkanContext->DeleteObject(image_view);
 
-        auto* allocation = m_allocation;
-        VulkanContext->DeleteObject(
-            [image, allocation, image_views] (vk::Device device, VmaAllocator allocator) -> void {
-            for (auto image_view : image_views | std::ranges::views::values)
-                device.destroy(image_view);
+        if (m_alias_allocation) {
+            // memory is owned by the pool
+            VulkanContext->DeleteObject(m_image);
+            VulkanContext->GetTransientAttachmentPool().Release(m_alias_allocation, this);
+            return;
+        }
 
-            vmaDestroyImage(allocator, image, allocation);
-        });
+        // memory moved by a pending defragmentation pass is freed by the pass
+        if (VulkanContext->GetDefragmenter().Remove(m_allocation)) {
+            VulkanContext->DeleteObject(m_image);
+            return;
+        }
+        VulkanContext->DeleteObject(m_image, m_allocation);
     }
 
     vk::ImageView Image::CreateGetImageView(const ImageSubresource& subresource) {
@@ -14,6 +14,36 @@ namespace DnmGL::Vulkan {
         }
     }
 
+    static constexpr vk::ShaderStageFlagBits ShaderStageToVkShaderStage(ShaderStageBits stage) {
+        switch (stage) {
+            // ShaderStageBits::eNone handled in Shader constructer
+            case ShaderStageBits::eNone: std::unreachable();
+            case ShaderStageBits::eVertex: return vk::ShaderStageFlagBits::eVertex;
+            case ShaderStageBits::eFragment: return vk::ShaderStageFlagBits::eFragment;
+            case ShaderStageBits::eCompute: return vk::ShaderStageFlagBits::eCompute;
+        }
+    }
+
+    // stages share one range, so a single vkCmdPushConstants updates all of them
+    static std::optional<vk::PushConstantRange> GetPushConstantRange(std::span<const EntryPointInfo *> entry_points) {
+        std::optional<vk::PushConstantRange> out;
+        for (const auto *entry_point : entry_points) {
+            if (!entry_point->HasPushConstant()) continue;
+            const auto [offset, size] = *entry_point->push_constant;
+
+            if (!out) {
+                out = vk::PushConstantRange{ShaderStageToVkShaderStage(entry_point->shader_stage), offset, size};
+                continue;
+            }
+
+            const auto end = std::max(out->offset + out->size, offset + size);
+            out->offset = std::min(out->offset, offset);
+            out->size = end - out->offset;
+            out->stageFlags |= ShaderStageToVkShaderStage(entry_point->shader_stage);
+        }
+        return out;
+    }
+
     static constexpr vk::AccessFlags GetAccessFlagsForEntryPoint(const EntryPointInfo &stage) {
         vk::AccessFlags out;
         if (stage.HasReadonlyResource())
@@ -46,17 +76,18 @@ namespace DnmGL::Vulkan {
         const auto device = VulkanContext->GetDevice();
 
         {
-            std::vector<vk::PushConstantRange> push_constants{};
-            
             vk::DescriptorSetLayout dst_set_layouts[4];
             const EntryPointInfo* entry_points[2] = {vertex_entry_point, frag_entry_point};
 
             typed_resource_manager->FillDescriptorSets(m_dst_sets, entry_points);
             typed_resource_manager->FillDescriptorSetLayouts(dst_set_layouts, entry_points);
+            m_push_constant_range = GetPushConstantRange(entry_points);
 
             vk::PipelineLayoutCreateInfo create_info{};
             create_info.setSetLayouts(dst_set_layouts)
                         ;
+            if (m_push_constant_range)
+                create_info.setPushConstantRanges(*m_push_constant_range);
 
             m_pipeline_layout = device.createPipelineLayout(create_info);
         }
@@ -69,8 +100,54 @@ namespace DnmGL::Vulkan {
         m_pipeline = CreatePipeline(VK_NULL_HANDLE);
     }
 
+    // fnv-1a of everything that identifies the pipeline between runs
+    static uint64_t GetManifestKey(const DnmGL::GraphicsPipelineDesc& desc) {
+        uint64_t hash = 0xcbf29ce484222325;
+        const auto hash_bytes = [&hash] (std::span<const std::byte> bytes) {
+            for (const auto byte : bytes) {
+                hash ^= uint64_t(byte);
+                hash *= 0x100000001b3;
+            }
+        };
+        // null terminated, so adjacent strings can not collide
+        const auto hash_string = [&hash_bytes] (std::string_view str) {
+            hash_bytes(std::as_bytes(std::span(str.data(), str.size() + 1)));
+        };
+
+        hash_string(desc.vertex_shader ? desc.vertex_shader->GetFilename() : "");
+        hash_string(desc.vertex_entry_point);
+        hash_string(desc.fragment_shader ? desc.fragment_shader->GetFilename() : "");
+        hash_string(desc.fragment_entry_point);
+        hash_bytes(std::as_bytes(std::span(desc.color_attachment_formats)));
+        hash_bytes(std::as_bytes(std::span(desc.vertex_binding_formats)));
+
+        const std::array<uint8_t, 12> state{
+            uint8_t(desc.depth_stencil_format),
+            uint8_t(desc.depth_test_compare_op),
+            uint8_t(desc.polygone_mode),
+            uint8_t(desc.cull_mode),
+            uint8_t(desc.front_face),
+            uint8_t(desc.topology),
+            uint8_t(desc.msaa),
+            uint8_t(desc.depth_test),
+            uint8_t(desc.depth_write),
+            uint8_t(desc.stencil_test),
+            uint8_t(desc.color_blend),
+            uint8_t(desc.color_attachment_formats.size()),
+        };
+        hash_bytes(std::as_bytes(std::span(state)));
+        return hash;
+    }
+
     GraphicsPipelineDefaultVk::GraphicsPipelineDefaultVk(Vulkan::Context& ctx, const DnmGL::GraphicsPipelineDesc& desc) noexcept
-        : GraphicsPipelineBase(ctx, desc) {}
+        : GraphicsPipelineBase(ctx, desc), 
+        m_manifest_key(Vulkan::GetManifestKey(desc)) {}
+
+    void GraphicsPipelineDefaultVk::WarmUp(std::span<const uint32_t> packed_variants) {
+        for (const auto packed_attachment_ops : packed_variants) {
+            GetOrCreateAttachmentOpVariant(AttachmentOps::FromPacked(packed_attachment_ops), packed_attachment_ops & 0b10);
+        }
+    }
 
     vk::RenderPass GraphicsPipelineDefaultVk::CreateRenderpass(AttachmentOps attachment_ops, bool presenting) noexcept {
         const auto device = VulkanContext->GetDevice();
@@ -354,6 +431,7 @@ namespace DnmGL::Vulkan {
 
         m_pipelines.emplace(vk_renderpass, vk_pipeline);
         it.first->second = vk_renderpass;
+        VulkanContext->RecordPipelineVariant(m_manifest_key, packed_attachment_ops);
 
         return {vk_renderpass, m_pipelines.at(vk_renderpass)};
     }
@@ -373,6 +451,23 @@ namespace DnmGL::Vulkan {
         const auto *typed_resource_manager = static_cast<const Vulkan::ResourceManager *>(m_desc.resource_manager);
         const auto device = VulkanContext->GetDevice();
 
+        {
+            vk::DescriptorSetLayout dst_set_layouts[4];
+            const EntryPointInfo* entry_points[1] = {shader_entry_point};
+
+            typed_resource_manager->FillDescriptorSets(m_dst_sets, entry_points);
+            typed_resource_manager->FillDescriptorSetLayouts(dst_set_layouts, entry_points);
+            m_push_constant_range = GetPushConstantRange(entry_points);
+
+            vk::PipelineLayoutCreateInfo create_info{};
+            create_info.setSetLayouts(dst_set_layouts)
+                        ;
+            if (m_push_constant_range)
+                create_info.setPushConstantRanges(*m_push_constant_range);
+
+            m_pipeline_layout = device.createPipelineLayout(create_info);
+        }
+
         vk::PipelineShaderStageCreateInfo stage_info{};
         stage_info.setStage(vk::ShaderStageFlagBits::eCompute)
                     .setModule(typed_shader->GetShaderModule())
@@ -385,6 +480,6 @@ namespace DnmGL::Vulkan {
                     .setLayout(m_pipeline_layout)
                     ;
 
-        m_pipeline = device.createComputePipeline(nullptr, pipeline_info).value;
+        m_pipeline = device.createComputePipeline(VulkanContext->GetPipelineCache(), pipeline_info).value;
     }
 }
\ No newline at end of file
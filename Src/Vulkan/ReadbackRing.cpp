@@ -0,0 +1,124 @@
+#include "DnmGL/Vulkan/ReadbackRing.hpp"
+
+#include <algorithm>
+
+namespace DnmGL::Vulkan {
+    ReadbackRing::ReadbackRing(Vulkan::Context& context, uint64_t capacity)
+        : m_context(&context) {
+        m_blocks.emplace_back(CreateBlock(capacity));
+    }
+
+    ReadbackRing::Allocation ReadbackRing::Allocate(uint64_t size, uint64_t alignment) {
+        DeleteUnusedBlocks();
+
+        auto *block = m_blocks.back().get();
+
+        auto offset = block->ring->Allocate(size, alignment);
+        if (!offset) {
+            Reclaim(*block);
+            offset = block->ring->Allocate(size, alignment);
+        }
+        if (!offset) {
+            // old block is deleted after its readbacks are released and completed
+            auto capacity = block->ring->GetCapacity() * 2;
+            while (capacity < size + alignment) capacity *= 2;
+
+            m_context->Message(std::format("readback ring grown to {} bytes", capacity), MessageType::eInfo);
+            if (block->readbacks.empty()) m_blocks.pop_back();
+            block = m_blocks.emplace_back(CreateBlock(capacity)).get();
+            offset = block->ring->Allocate(size, alignment);
+        }
+
+        const auto id = m_next_id++;
+        m_readbacks.emplace(id, Readback{
+            .block = block,
+            .tag = m_context->GetSubmissionTag(),
+            .offset = *offset,
+            .size = size,
+            .released = false,
+            .ready = false,
+        });
+        block->readbacks.emplace_back(id);
+
+        m_used += size;
+        m_high_water_mark = std::max(m_high_water_mark, m_used);
+
+        return {block->ring->GetBuffer(), *offset, {id}};
+    }
+
+    std::span<const std::byte> ReadbackRing::GetData(ReadbackHandle handle) {
+        const auto it = m_readbacks.find(handle.id);
+        if (it == m_readbacks.end() || it->second.released) {
+            m_context->Message(std::format("readback {} is invalid or released", handle.id), MessageType::eInvalidBehavior);
+            return {};
+        }
+
+        auto& readback = it->second;
+        if (!readback.ready) {
+            if (!IsComplete(readback.tag)) return {};
+
+            vmaInvalidateAllocation(m_context->GetVmaAllocator(), readback.block->ring->GetAllocation(), readback.offset, readback.size);
+            readback.ready = true;
+        }
+
+        return {readback.block->ring->GetMappedPtr() + readback.offset, readback.size};
+    }
+
+    void ReadbackRing::Release(ReadbackHandle handle) {
+        const auto it = m_readbacks.find(handle.id);
+        if (it == m_readbacks.end() || it->second.released) {
+            m_context->Message(std::format("readback {} is invalid or already released", handle.id), MessageType::eInvalidBehavior);
+            return;
+        }
+
+        it->second.released = true;
+        m_used -= it->second.size;
+
+        Reclaim(*it->second.block);
+        DeleteUnusedBlocks();
+    }
+
+    void ReadbackRing::Reclaim(Block& block) {
+        while (!block.readbacks.empty()) {
+            const auto it = m_readbacks.find(block.readbacks.front());
+            if (!it->second.released || !IsComplete(it->second.tag)) break;
+
+            block.ring->Free(it->second.offset + it->second.size);
+            m_readbacks.erase(it);
+            block.readbacks.pop_front();
+        }
+        if (block.readbacks.empty()) block.ring->Clear();
+    }
+
+    void ReadbackRing::DeleteUnusedBlocks() {
+        // readbacks released before their submission completed are reclaimed here
+        for (const auto& block : m_blocks | std::views::take(m_blocks.size() - 1)) {
+            Reclaim(*block);
+        }
+        const auto *last_block = m_blocks.back().get();
+        std::erase_if(m_blocks, [last_block] (const auto& block) { 
+            return block.get() != last_block && block->readbacks.empty(); 
+        });
+    }
+
+    bool ReadbackRing::IsComplete(const Vulkan::Context::SubmissionTag& tag) {
+        if (m_context->IsComplete(tag)) return true;
+
+        // completed frame count is only updated by ticket queries
+        m_context->UpdateCompletedCounts();
+        if (!m_context->IsComplete(tag.frame_count)) return false;
+        return m_context->IsComplete(tag);
+    }
+
+    std::unique_ptr<ReadbackRing::Block> ReadbackRing::CreateBlock(uint64_t capacity) {
+        auto block = std::make_unique<Block>();
+        // cached host memory, reads of write combined memory are very slow
+        block->ring = std::make_unique<RingBuffer>(
+            *m_context, 
+            capacity, 
+            vk::BufferUsageFlagBits::eTransferDst, 
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT, 
+            "readback");
+        return block;
+    }
+}
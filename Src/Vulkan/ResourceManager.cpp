@@ -24,7 +24,8 @@ namespace DnmGL::Vulkan {
             case ResourceType::eReadonlyImage: return vk::DescriptorType::eSampledImage;
             case ResourceType::eWritableBuffer: return vk::DescriptorType::eStorageBuffer;
             case ResourceType::eWritableImage: return vk::DescriptorType::eStorageImage;
-            case ResourceType::eUniformBuffer: return vk::DescriptorType::eUniformBuffer;
+            // offsets of transient uniforms are applied at bind time
+            case ResourceType::eUniformBuffer: return vk::DescriptorType::eUniformBufferDynamic;
             case ResourceType::eSampler: return vk::DescriptorType::eSampler;
           break;
         }
@@ -174,346 +175,321 @@ namespace DnmGL::Vulkan {
                 device.allocateDescriptorSets(alloc_info), 
                 m_dst_sets.begin());
         }
-    }
 
-    void ResourceManager::ISetReadonlyResource(std::span<const ResourceDesc> update_resource) {        
-        const auto supported_features = VulkanContext->GetSupportedFeatures();
-        const auto context_state = VulkanContext->GetContextState();
+        // dynamic offsets are ordered by binding number
+        std::ranges::sort(uniform_bindings, {}, &vk::DescriptorSetLayoutBinding::binding);
+        for (const auto& binding : uniform_bindings) {
+            m_dynamic_offset_indices.emplace_back(binding.binding, m_dynamic_offset_count);
+            m_dynamic_offset_count += binding.descriptorCount;
+        }
 
-        // usually these three are supported together
-        const bool buffer_uab = supported_features.storage_buffer_update_after_bind;
-        const bool image_uab = supported_features.storage_image_update_after_bind;
-        const bool texture_uab = supported_features.sampled_image_update_after_bind;
+        // uniforms point to the transient uniform buffer until SetUniformResource is called
+        {
+            const vk::DescriptorBufferInfo info{
+                VulkanContext->GetTransientUniformBuffer()->GetBuffer(),
+                0,
+                VulkanContext->GetTransientUniformRange()
+            };
 
-        if ((context_state == ContextState::eNone || context_state == ContextState::eCommandBufferRecording)
-        || (buffer_uab && image_uab && texture_uab)) {
             std::vector<vk::WriteDescriptorSet> writes{};
-            std::vector<vk::DescriptorImageInfo> image_infos{};
-            std::vector<vk::DescriptorBufferInfo> buffer_infos{};
-
-            writes.reserve(update_resource.size());
-            image_infos.reserve(update_resource.size());
-            buffer_infos.reserve(update_resource.size());
-
-            vk::DescriptorBufferInfo *buffer_info{};
-            vk::DescriptorImageInfo *image_info{};
-            vk::DescriptorType type;
-
-            for (const auto &resource : update_resource) {
-                if (resource.buffer) {
-                    const auto *typed_buffer
-                        = static_cast<const Vulkan::Buffer *>(resource.buffer);
-
-                    buffer_info = &buffer_infos.emplace_back(
-                        typed_buffer->GetBuffer(),
-                        resource.first_element * typed_buffer->GetDesc().element_size,
-                        resource.element_count * typed_buffer->GetDesc().element_size
-                    );
-
-                    type = vk::DescriptorType::eStorageBuffer;
-                }
-                else if (resource.image) {
-                    auto *typed_image
-                        = static_cast<Vulkan::Image *>(resource.image);
-
-                    image_info = &image_infos.emplace_back(
+            for (const auto& binding : uniform_bindings) {
+                for (const auto i : Counter(binding.descriptorCount)) {
+                    writes.emplace_back(
+                        GetUniformSet(),
+                        binding.binding,
+                        i,
+                        1,
+                        vk::DescriptorType::eUniformBufferDynamic,
                         nullptr,
-                        typed_image->CreateGetImageView(resource.subresource),
-                        typed_image->GetIdealImageLayout()
+                        &info,
+                        nullptr
                     );
-
-                    //I did this relying on SDLGPU.
-                    type = vk::DescriptorType::eSampledImage;
                 }
-                else continue;
-                
-                writes.emplace_back(
-                    GetReadonlySet(),
-                    resource.binding,
-                    resource.array_element,
-                    1,
-                    type,
-                    image_info,
-                    buffer_info,
-                    nullptr
-                );
             }
 
-            VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+            if (!writes.empty())
+                device.updateDescriptorSets(writes, {});
         }
-        else {
-            std::vector<Context::InternalBufferResource> buffer_defer_updates{};
-            std::vector<Context::InternalImageResource> image_defer_updates{};
-
-            buffer_defer_updates.reserve(update_resource.size());
-            image_defer_updates.reserve(update_resource.size());
-
-            for (const auto &resource : update_resource) {
-                if (resource.buffer) {
-                    const auto *typed_buffer
-                        = static_cast<const Vulkan::Buffer *>(resource.buffer);
-    
-                    buffer_defer_updates.emplace_back(
-                        typed_buffer->GetBuffer(),
-                        vk::DescriptorType::eStorageBuffer,
-                        resource.first_element * typed_buffer->GetDesc().element_size,
-                        resource.element_count * typed_buffer->GetDesc().element_size,
-                        GetReadonlySet(),
-                        resource.binding,       
-                        resource.array_element
-                    );
-                }
-                else if (resource.image) {
-                    auto *typed_image
-                        = static_cast<Vulkan::Image *>(resource.image);
-    
-                    image_defer_updates.emplace_back(
-                        typed_image->CreateGetImageView(resource.subresource),
-                        typed_image->GetIdealImageLayout(),
-                        vk::DescriptorType::eSampledImage, //TODO: fix this
-                        GetReadonlySet(),
-                        resource.binding,       
-                        resource.array_element
-                    );
-                }
-            }
 
-            if(!buffer_defer_updates.empty())
-                VulkanContext->DeferResourceUpdate(buffer_defer_updates);
-            if(!image_defer_updates.empty())
-                VulkanContext->DeferResourceUpdate(image_defer_updates);
+        VulkanContext->AddResourceManager(this);
+    }
+
+    template <typename T>
+    static void RecordResources(std::map<std::pair<uint32_t, uint32_t>, T>& resources, std::span<const T> update_resource) {
+        for (const auto& resource : update_resource) {
+            bool has_resource = (resource.buffer != nullptr);
+            if constexpr (std::is_same_v<T, ResourceDesc>) has_resource |= (resource.image != nullptr);
+
+            if (has_resource) resources.insert_or_assign({resource.binding, resource.array_element}, resource);
+            else resources.erase({resource.binding, resource.array_element});
         }
     }
 
-    void ResourceManager::ISetWritableResource(std::span<const ResourceDesc> update_resource) {
-        const auto supported_features = VulkanContext->GetSupportedFeatures();
-        const auto context_state = VulkanContext->GetContextState();
+    void ResourceManager::RewriteResources(const std::unordered_set<const void *>& resources) {
+        std::vector<ResourceDesc> readonly_resources{};
+        std::vector<ResourceDesc> writable_resources{};
+        std::vector<UniformResourceDesc> uniform_resources{};
 
-        // usually these 2 are supported together
-        const bool buffer_uab = supported_features.storage_buffer_update_after_bind;
-        const bool image_uab = supported_features.storage_image_update_after_bind;
+        for (const auto& resource : m_readonly_resources | std::views::values) {
+            if (resources.contains(resource.buffer) || resources.contains(resource.image))
+                readonly_resources.emplace_back(resource);
+        }
+        for (const auto& resource : m_writable_resources | std::views::values) {
+            if (resources.contains(resource.buffer) || resources.contains(resource.image))
+                writable_resources.emplace_back(resource);
+        }
+        for (const auto& resource : m_uniform_resources | std::views::values) {
+            if (resources.contains(resource.buffer))
+                uniform_resources.emplace_back(resource);
+        }
 
-        if ((context_state == ContextState::eNone || context_state == ContextState::eCommandBufferRecording)
-        || (buffer_uab && image_uab)) {
-            std::vector<vk::WriteDescriptorSet> writes{};
-            std::vector<vk::DescriptorImageInfo> image_infos{};
-            std::vector<vk::DescriptorBufferInfo> buffer_infos{};
-
-            writes.reserve(update_resource.size());
-            image_infos.reserve(update_resource.size());
-            buffer_infos.reserve(update_resource.size());
-
-            vk::DescriptorBufferInfo *buffer_info{};
-            vk::DescriptorImageInfo *image_info{};
-            vk::DescriptorType type;
-
-            for (const auto &resource : update_resource) {
-                if (resource.buffer) {
-                    const auto *typed_buffer
-                        = static_cast<const Vulkan::Buffer *>(resource.buffer);
-
-                    buffer_info = &buffer_infos.emplace_back(
-                        typed_buffer->GetBuffer(),
-                        resource.first_element * typed_buffer->GetDesc().element_size,
-                        resource.element_count * typed_buffer->GetDesc().element_size
-                    );
+        if (!readonly_resources.empty()) ISetReadonlyResource(readonly_resources);
+        if (!writable_resources.empty()) ISetWritableResource(writable_resources);
+        if (!uniform_resources.empty()) ISetUniformResource(uniform_resources);
+    }
 
-                    type = vk::DescriptorType::eStorageBuffer;
-                }
-                else if (resource.image) {
-                    auto *typed_image
-                        = static_cast<Vulkan::Image *>(resource.image);
+    vk::DescriptorSet ResourceManager::GetSetForWrite(uint32_t set_index) {
+        auto& set = m_dst_sets[set_index];
 
-                    image_info = &image_infos.emplace_back(
-                        nullptr,
-                        typed_image->CreateGetImageView(resource.subresource),
-                        typed_image->GetIdealImageLayout()
-                    );
+        VulkanContext->UpdateCompletedCounts();
+        if (VulkanContext->IsComplete(m_set_use_tags[set_index])) return set;
 
-                    type = vk::DescriptorType::eStorageImage;
-                }
-                else continue;
-                
-                writes.emplace_back(
-                    GetWritableSet(),
-                    resource.binding,
-                    resource.array_element,
-                    1,
-                    type,
-                    image_info,
-                    buffer_info,
-                    nullptr
-                );
-            }
+        const auto device = VulkanContext->GetDevice();
 
-            VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+        vk::DescriptorSetAllocateInfo alloc_info;
+        alloc_info.setSetLayouts(m_dst_set_layouts[set_index])
+                    .setDescriptorPool(VulkanContext->GetDescriptorPool())
+                    ;
+
+        vk::DescriptorSet new_set;
+        if (device.allocateDescriptorSets(&alloc_info, &new_set) != vk::Result::eSuccess) {
+            VulkanContext->Message("descriptor pool is full, waiting for gpu to write descriptor set", MessageType::eWarning);
+            VulkanContext->WaitForGPU();
+            return set;
         }
-        else {
-            std::vector<Context::InternalBufferResource> buffer_defer_updates{};
-            std::vector<Context::InternalImageResource> image_defer_updates{};
-
-            buffer_defer_updates.reserve(update_resource.size());
-            image_defer_updates.reserve(update_resource.size());
-
-            for (const auto &resource : update_resource) {
-                if (resource.buffer) {
-                    const auto *typed_buffer
-                        = static_cast<const Vulkan::Buffer *>(resource.buffer);
-    
-                    buffer_defer_updates.emplace_back(
-                        typed_buffer->GetBuffer(),
-                        vk::DescriptorType::eStorageBuffer,
-                        resource.first_element * typed_buffer->GetDesc().element_size,
-                        resource.element_count * typed_buffer->GetDesc().element_size,
-                        GetWritableSet(),
-                        resource.binding,       
-                        resource.array_element
-                    );
-                }
-                else if (resource.image) {
-                    auto *typed_image
-                        = static_cast<Vulkan::Image *>(resource.image);
-    
-                    image_defer_updates.emplace_back(
-                        typed_image->CreateGetImageView(resource.subresource),
-                        typed_image->GetIdealImageLayout(),
-                        vk::DescriptorType::eStorageImage,
-                        GetWritableSet(),
-                        resource.binding,       
-                        resource.array_element
-                    );
-                }
-            }
 
-            if(!buffer_defer_updates.empty())
-                VulkanContext->DeferResourceUpdate(buffer_defer_updates);
-            if(!image_defer_updates.empty())
-                VulkanContext->DeferResourceUpdate(image_defer_updates);
+        const std::span<const BindingInfo> bindings[4] = {
+            GetReadonlyResources(), 
+            GetWritableResources(), 
+            GetUniformResources(), 
+            GetSamplerResources()
+        };
+
+        // descriptors which are not written are copied from the replaced set
+        std::vector<vk::CopyDescriptorSet> copies{};
+        copies.reserve(bindings[set_index].size());
+        for (const auto& binding : bindings[set_index]) {
+            copies.emplace_back(
+                set,
+                binding.binding,
+                0,
+                new_set,
+                binding.binding,
+                0,
+                binding.resource_count
+            );
         }
+
+        if (!copies.empty())
+            device.updateDescriptorSets({}, copies);
+
+        VulkanContext->DeleteObject(set);
+        set = new_set;
+        m_set_use_tags[set_index] = {};
+        return set;
     }
 
-    void ResourceManager::ISetUniformResource(std::span<const UniformResourceDesc> update_resource) {
-        const auto supported_features = VulkanContext->GetSupportedFeatures();
-        const auto context_state = VulkanContext->GetContextState();
+    void ResourceManager::ISetReadonlyResource(std::span<const ResourceDesc> update_resource) {        
+        RecordResources(m_readonly_resources, update_resource);
+        // views of streaming images are clamped to resident mips, rewritten when more mips arrive
 
-        if ((context_state == ContextState::eNone || context_state == ContextState::eCommandBufferRecording)
-        || (supported_features.uniform_buffer_update_after_bind)) {
-            std::vector<vk::WriteDescriptorSet> writes{};
-            std::vector<vk::DescriptorBufferInfo> buffer_infos{};
+        const auto set = GetSetForWrite(0);
 
-            writes.reserve(update_resource.size());
-            buffer_infos.reserve(update_resource.size());
+        std::vector<vk::WriteDescriptorSet> writes{};
+        std::vector<vk::DescriptorImageInfo> image_infos{};
+        std::vector<vk::DescriptorBufferInfo> buffer_infos{};
 
-            for (const auto &resource : update_resource) {
-                if (!resource.buffer) continue;
+        writes.reserve(update_resource.size());
+        image_infos.reserve(update_resource.size());
+        buffer_infos.reserve(update_resource.size());
 
+        vk::DescriptorBufferInfo *buffer_info{};
+        vk::DescriptorImageInfo *image_info{};
+        vk::DescriptorType type;
+
+        for (const auto &resource : update_resource) {
+            if (resource.buffer) {
                 const auto *typed_buffer
                     = static_cast<const Vulkan::Buffer *>(resource.buffer);
 
-                const auto *info = &buffer_infos.emplace_back(
+                buffer_info = &buffer_infos.emplace_back(
                     typed_buffer->GetBuffer(),
-                    resource.offset,
-                    resource.size
+                    resource.first_element * typed_buffer->GetDesc().element_size,
+                    resource.element_count * typed_buffer->GetDesc().element_size
                 );
 
-                writes.emplace_back(
-                    GetUniformSet(),
-                    resource.binding,
-                    resource.array_element,
-                    1,
-                    vk::DescriptorType::eUniformBuffer,
+                type = vk::DescriptorType::eStorageBuffer;
+            }
+            else if (resource.image) {
+                auto *typed_image
+                    = static_cast<Vulkan::Image *>(resource.image);
+
+                image_info = &image_infos.emplace_back(
                     nullptr,
-                    info,
-                    nullptr
+                    typed_image->CreateGetImageView(typed_image->GetResidentSubresource(resource.subresource)),
+                    typed_image->GetIdealImageLayout()
                 );
-            }
 
-            VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+                //I did this relying on SDLGPU.
+                type = vk::DescriptorType::eSampledImage;
+            }
+            else continue;
+            
+            writes.emplace_back(
+                set,
+                resource.binding,
+                resource.array_element,
+                1,
+                type,
+                image_info,
+                buffer_info,
+                nullptr
+            );
         }
-        else {
-            std::vector<Context::InternalBufferResource> defer_updates{};
-            defer_updates.reserve(update_resource.size());
 
-            for (const auto &resource : update_resource) {
-                if (resource.buffer) continue;
+        VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+    }
 
-                const auto *typed_buffer
-                    = static_cast<const Vulkan::Buffer *>(resource.buffer);
+    void ResourceManager::ISetWritableResource(std::span<const ResourceDesc> update_resource) {
+        RecordResources(m_writable_resources, update_resource);
 
-                defer_updates.emplace_back(
-                    typed_buffer->GetBuffer(),
-                    vk::DescriptorType::eUniformBuffer,
-                    resource.offset,
-                    resource.size,
-                    GetUniformSet(),
-                    resource.binding,       
-                    resource.array_element
-                );
-            }
+        const auto set = GetSetForWrite(1);
 
-            if(!defer_updates.empty())
-                VulkanContext->DeferResourceUpdate(defer_updates);
-        }
-    }
+        std::vector<vk::WriteDescriptorSet> writes{};
+        std::vector<vk::DescriptorImageInfo> image_infos{};
+        std::vector<vk::DescriptorBufferInfo> buffer_infos{};
 
-    void ResourceManager::ISetSamplerResource(std::span<const SamplerResourceDesc> update_resource) {
-        const auto supported_features = VulkanContext->GetSupportedFeatures();
-        const auto context_state = VulkanContext->GetContextState();
+        writes.reserve(update_resource.size());
+        image_infos.reserve(update_resource.size());
+        buffer_infos.reserve(update_resource.size());
 
-        if ((context_state == ContextState::eNone || context_state == ContextState::eCommandBufferRecording)
-        || (supported_features.sampled_image_update_after_bind)) {
-            std::vector<vk::WriteDescriptorSet> writes{};
-            std::vector<vk::DescriptorImageInfo> image_infos{};
+        vk::DescriptorBufferInfo *buffer_info{};
+        vk::DescriptorImageInfo *image_info{};
+        vk::DescriptorType type;
 
-            writes.reserve(update_resource.size());
-            image_infos.reserve(update_resource.size());
+        for (const auto &resource : update_resource) {
+            if (resource.buffer) {
+                const auto *typed_buffer
+                    = static_cast<const Vulkan::Buffer *>(resource.buffer);
 
-            for (const auto &resource : update_resource) {
-                if (!resource.sampler) continue;
+                buffer_info = &buffer_infos.emplace_back(
+                    typed_buffer->GetBuffer(),
+                    resource.first_element * typed_buffer->GetDesc().element_size,
+                    resource.element_count * typed_buffer->GetDesc().element_size
+                );
 
-                const auto *typed_sampler
-                    = static_cast<const Vulkan::Sampler *>(resource.sampler);
+                type = vk::DescriptorType::eStorageBuffer;
+            }
+            else if (resource.image) {
+                auto *typed_image
+                    = static_cast<Vulkan::Image *>(resource.image);
 
-                const auto *info = &image_infos.emplace_back(
-                    typed_sampler->GetSampler(),
+                image_info = &image_infos.emplace_back(
                     nullptr,
-                    vk::ImageLayout{}
+                    typed_image->CreateGetImageView(resource.subresource),
+                    typed_image->GetIdealImageLayout()
                 );
 
-                writes.emplace_back(
-                    GetSamplerSet(),
-                    resource.binding,
-                    resource.array_element,
-                    1,
-                    vk::DescriptorType::eSampler,
-                    info,
-                    nullptr,
-                    nullptr
-                );
+                type = vk::DescriptorType::eStorageImage;
             }
-
-            VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+            else continue;
+            
+            writes.emplace_back(
+                set,
+                resource.binding,
+                resource.array_element,
+                1,
+                type,
+                image_info,
+                buffer_info,
+                nullptr
+            );
         }
-        else {
-            std::vector<Context::InternalSamplerResource> defer_updates{};
-            defer_updates.reserve(update_resource.size());
 
-            for (const auto &resource : update_resource) {
-                if (resource.sampler) continue;
+        VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+    }
 
-                const auto *typed_sampler
-                    = static_cast<const Vulkan::Sampler *>(resource.sampler);
+    void ResourceManager::ISetUniformResource(std::span<const UniformResourceDesc> update_resource) {
+        RecordResources(m_uniform_resources, update_resource);
+
+        const auto set = GetSetForWrite(2);
+
+        std::vector<vk::WriteDescriptorSet> writes{};
+        std::vector<vk::DescriptorBufferInfo> buffer_infos{};
+
+        writes.reserve(update_resource.size());
+        buffer_infos.reserve(update_resource.size());
+
+        for (const auto &resource : update_resource) {
+            if (!resource.buffer) continue;
+
+            const auto *typed_buffer
+                = static_cast<const Vulkan::Buffer *>(resource.buffer);
+
+            const auto *info = &buffer_infos.emplace_back(
+                typed_buffer->GetBuffer(),
+                resource.offset,
+                resource.size
+            );
+
+            writes.emplace_back(
+                set,
+                resource.binding,
+                resource.array_element,
+                1,
+                vk::DescriptorType::eUniformBufferDynamic,
+                nullptr,
+                info,
+                nullptr
+            );
+        }
 
-                defer_updates.emplace_back(
-                    typed_sampler->GetSampler(),
-                    GetSamplerSet(),
-                    resource.binding,       
-                    resource.array_element
-                );
-            }
+        VulkanContext->GetDevice().updateDescriptorSets(writes, {});
+    }
+
+    void ResourceManager::ISetSamplerResource(std::span<const SamplerResourceDesc> update_resource) {
+        const auto set = GetSetForWrite(3);
+
+        std::vector<vk::WriteDescriptorSet> writes{};
+        std::vector<vk::DescriptorImageInfo> image_infos{};
+
+        writes.reserve(update_resource.size());
+        image_infos.reserve(update_resource.size());
+
+        for (const auto &resource : update_resource) {
+            if (!resource.sampler) continue;
+
+            const auto *typed_sampler
+                = static_cast<const Vulkan::Sampler *>(resource.sampler);
+
+            const auto *info = &image_infos.emplace_back(
+                typed_sampler->GetSampler(),
+                nullptr,
+                vk::ImageLayout{}
+            );
+
+            writes.emplace_back(
+                set,
+                resource.binding,
+                resource.array_element,
+                1,
+                vk::DescriptorType::eSampler,
+                info,
+                nullptr,
+                nullptr
+            );
+        }
 
-            if(!defer_updates.empty())
-                VulkanContext->DeferResourceUpdate(defer_updates);
-        }   
+        VulkanContext->GetDevice().updateDescriptorSets(writes, {});
     }
-} // namespace DnmGL::Vulkan
\ No newline at end of file
+} // namespace DnmGL::Vulkan
@@ -0,0 +1,94 @@
+#include "DnmGL/Vulkan/RingBuffer.hpp"
+
+#include <algorithm>
+
+namespace DnmGL::Vulkan {
+    static constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    RingBuffer::RingBuffer(Vulkan::Context& context, uint64_t capacity, vk::BufferUsageFlags usage, VmaAllocationCreateFlags host_access_flags, std::string_view name)
+        : m_context(&context), m_capacity(capacity) {
+        // ring is used by every queue family without ownership transfer
+        const auto device_features = m_context->GetDeviceFeatures();
+        std::vector<uint32_t> queue_families{device_features.queue_family};
+        for (const auto queue_family : {device_features.transfer_queue_family, device_features.compute_queue_family}) {
+            if (!std::ranges::contains(queue_families, queue_family))
+                queue_families.emplace_back(queue_family);
+        }
+
+        VkBufferCreateInfo buffer_create_info{};
+        buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_create_info.usage = static_cast<VkBufferUsageFlags>(usage);
+        buffer_create_info.size = capacity;
+        buffer_create_info.sharingMode = VkSharingMode::VK_SHARING_MODE_EXCLUSIVE;
+        if (queue_families.size() > 1) {
+            buffer_create_info.sharingMode = VkSharingMode::VK_SHARING_MODE_CONCURRENT;
+            buffer_create_info.queueFamilyIndexCount = static_cast<uint32_t>(queue_families.size());
+            buffer_create_info.pQueueFamilyIndices = queue_families.data();
+        }
+
+        VmaAllocationCreateInfo alloc_create_info{};
+        alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+        alloc_create_info.flags = host_access_flags | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        m_context->ApplyMemoryPool(MemoryPoolType::eStaging, capacity, buffer_create_info, alloc_create_info);
+
+        VmaAllocationInfo alloc_info;
+        auto result = (vk::Result)vmaCreateBuffer(m_context->GetVmaAllocator(),
+                &buffer_create_info,
+                &alloc_create_info,
+                reinterpret_cast<VkBuffer*>(&m_buffer),
+                &m_allocation,
+                &alloc_info);
+
+        // pool block may be full or too small
+        if (alloc_create_info.pool && result != vk::Result::eSuccess) {
+            alloc_create_info.pool = VK_NULL_HANDLE;
+            result = (vk::Result)vmaCreateBuffer(m_context->GetVmaAllocator(),
+                &buffer_create_info,
+                &alloc_create_info,
+                reinterpret_cast<VkBuffer*>(&m_buffer),
+                &m_allocation,
+                &alloc_info);
+        }
+
+        if (result == vk::Result::eErrorOutOfDeviceMemory || result == vk::Result::eErrorOutOfHostMemory) {
+            m_context->Message(std::format("vmaCreateBuffer create {} buffer failed, out of memory", name), MessageType::eOutOfMemory);
+        }
+        else if (result != vk::Result::eSuccess) {
+            m_context->Message(std::format("vmaCreateBuffer create {} buffer failed, unknown", name), MessageType::eUnknown);
+        }
+        else {
+            m_context->TrackAllocation(m_allocation, MemoryCategory::eStaging);
+        }
+
+        m_mapped_ptr = reinterpret_cast<std::byte*>(alloc_info.pMappedData);
+    }
+
+    RingBuffer::~RingBuffer() {
+        // deleted after the submissions using it are completed
+        m_context->DeleteObject(m_buffer, m_allocation);
+    }
+
+    std::optional<uint64_t> RingBuffer::Allocate(uint64_t size, uint64_t alignment) {
+        // full
+        if (!m_empty && m_head == m_tail) return std::nullopt;
+
+        const auto aligned_head = AlignUp(m_head, alignment);
+
+        std::optional<uint64_t> offset{};
+        // free space is [head, capacity) and [0, tail)
+        if (m_head >= m_tail) {
+            if (aligned_head + size <= m_capacity) offset = aligned_head;
+            else if (size <= m_tail) offset = 0;
+        }
+        // free space is [head, tail)
+        else if (aligned_head + size <= m_tail) offset = aligned_head;
+
+        if (offset) {
+            m_head = *offset + size;
+            m_empty = false;
+        }
+        return offset;
+    }
+}
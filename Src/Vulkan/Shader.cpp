@@ -146,6 +146,22 @@ namespace DnmGL::Vulkan {
                     }
                 }
             }
+
+            // push constant
+            {
+                uint32_t count{};
+                reflection.EnumerateEntryPointPushConstantBlocks(entry_point_name.data(), &count, nullptr);
+                std::vector<SpvReflectBlockVariable *> blocks(count);
+                reflection.EnumerateEntryPointPushConstantBlocks(entry_point_name.data(), &count, blocks.data());
+
+                // only one push constant block is allowed per entry point
+                if (!blocks.empty()) {
+                    entry_point_info.push_constant = DnmGL::PushConstantRange{
+                        blocks[0]->offset,
+                        blocks[0]->size,
+                    };
+                }
+            }
         }
 
         //create shader module
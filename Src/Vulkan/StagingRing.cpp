@@ -0,0 +1,69 @@
+#include "DnmGL/Vulkan/StagingRing.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace DnmGL::Vulkan {
+    StagingRing::StagingRing(Vulkan::Context& context, uint64_t capacity)
+        : m_context(&context) {
+        m_ring = CreateRing(capacity);
+    }
+
+    StagingRing::Allocation StagingRing::Write(const void *data, uint64_t size, uint64_t alignment) {
+        auto offset = m_ring->Allocate(size, alignment);
+        if (!offset) {
+            Reclaim();
+            offset = m_ring->Allocate(size, alignment);
+        }
+        if (!offset) {
+            // old buffer is deleted after the submissions using it are completed
+            auto capacity = m_ring->GetCapacity() * 2;
+            while (capacity < size + alignment) capacity *= 2;
+
+            m_context->Message(std::format("staging ring grown to {} bytes", capacity), MessageType::eInfo);
+            m_ring = CreateRing(capacity);
+            m_regions.clear();
+            offset = m_ring->Allocate(size, alignment);
+        }
+
+        std::memcpy(m_ring->GetMappedPtr() + *offset, data, size);
+        vmaFlushAllocation(m_context->GetVmaAllocator(), m_ring->GetAllocation(), *offset, size);
+
+        const auto end = *offset + size;
+
+        // allocations of the same submission share a region
+        const auto tag = m_context->GetSubmissionTag();
+        if (!m_regions.empty()
+            && m_regions.back().tag.frame_count == tag.frame_count
+            && m_regions.back().tag.transfer_count == tag.transfer_count
+            && m_regions.back().tag.compute_count == tag.compute_count) {
+            m_regions.back().end = end;
+        }
+        else {
+            m_regions.emplace_back(tag, end);
+        }
+
+        m_high_water_mark = std::max(m_high_water_mark, m_ring->GetUsedBytes());
+
+        return {m_ring->GetBuffer(), *offset};
+    }
+
+    void StagingRing::Reclaim() {
+        m_context->UpdateCompletedCounts();
+
+        while (!m_regions.empty() && m_context->IsComplete(m_regions.front().tag)) {
+            m_ring->Free(m_regions.front().end);
+            m_regions.pop_front();
+        }
+        if (m_regions.empty()) m_ring->Clear();
+    }
+
+    std::unique_ptr<RingBuffer> StagingRing::CreateRing(uint64_t capacity) {
+        return std::make_unique<RingBuffer>(
+            *m_context, 
+            capacity, 
+            vk::BufferUsageFlagBits::eTransferSrc, 
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, 
+            "staging");
+    }
+}
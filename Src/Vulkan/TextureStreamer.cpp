@@ -0,0 +1,116 @@
+#include "DnmGL/Vulkan/TextureStreamer.hpp"
+#include "DnmGL/Vulkan/CommandBuffer.hpp"
+#include "DnmGL/Vulkan/Image.hpp"
+
+#include <ranges>
+#include <unordered_set>
+
+namespace DnmGL::Vulkan {
+    static constexpr uint64_t GetMipSize(const DnmGL::ImageDesc& desc, uint32_t mip) {
+        const uint64_t width = std::max(desc.extent.x >> mip, 1u);
+        const uint64_t height = std::max(desc.extent.y >> mip, 1u);
+        // z is array count for 2D images
+        const uint64_t depth = (desc.type == ImageType::e3D) ? std::max(desc.extent.z >> mip, 1u) : desc.extent.z;
+        return width * height * depth * GetFormatSize(desc.format);
+    }
+
+    bool TextureStreamer::Add(Vulkan::Image *image, std::vector<std::vector<std::byte>>&& mip_data) {
+        const auto& desc = image->GetDesc();
+        for (const auto mip : Counter(desc.mipmap_levels)) {
+            if (mip_data[mip].size() < GetMipSize(desc, mip)) {
+                m_context->Message(
+                    std::format("mip data size must be equal or bigger than mip size; mip: {}, data size: {}, mip size: {}",
+                    mip, mip_data[mip].size(), GetMipSize(desc, mip)), 
+                    MessageType::eInvalidBehavior);
+                return false;
+            }
+        }
+
+        image->m_resident_mip = desc.mipmap_levels;
+        m_entries.emplace_back(image, std::move(mip_data), desc.mipmap_levels);
+        return true;
+    }
+
+    bool TextureStreamer::Update(Vulkan::CommandBuffer& command_buffer) {
+        // recordings of a command buffer that is not submitted are dropped
+        for (auto& entry : m_entries) {
+            entry.recorded_mip = entry.image->m_resident_mip;
+        }
+
+        uint64_t uploaded_bytes{};
+        bool recorded{};
+
+        while (true) {
+            // smallest pending mip of every image first, so every image gets a low resolution version early
+            Entry *next{};
+            for (auto& entry : m_entries) {
+                if (entry.recorded_mip == 0) continue;
+                if (!next || GetMipSize(entry.image->GetDesc(), entry.recorded_mip - 1) < GetMipSize(next->image->GetDesc(), next->recorded_mip - 1))
+                    next = &entry;
+            }
+            if (!next) break;
+
+            const auto mip = next->recorded_mip - 1;
+            const auto mip_size = GetMipSize(next->image->GetDesc(), mip);
+            if (uploaded_bytes != 0 && uploaded_bytes + mip_size > m_budget) break;
+
+            Upload(command_buffer, *next, mip);
+            uploaded_bytes += mip_size;
+            next->recorded_mip = mip;
+            recorded = true;
+        }
+
+        return recorded;
+    }
+
+    void TextureStreamer::Commit() {
+        std::unordered_set<const void *> changed_images{};
+
+        for (auto& entry : m_entries) {
+            if (entry.recorded_mip == entry.image->m_resident_mip) continue;
+
+            // data is in staging memory of the submission now
+            for (const auto mip : std::views::iota(entry.recorded_mip, entry.image->m_resident_mip)) {
+                entry.mip_data[mip] = {};
+            }
+            entry.image->m_resident_mip = entry.recorded_mip;
+            changed_images.insert(static_cast<const DnmGL::Image*>(entry.image));
+        }
+
+        std::erase_if(m_entries, [] (const Entry& entry) { return entry.recorded_mip == 0; });
+
+        if (!changed_images.empty()) m_context->RewriteResources(changed_images);
+    }
+
+    void TextureStreamer::Upload(Vulkan::CommandBuffer& command_buffer, Entry& entry, uint32_t mip) {
+        const auto& desc = entry.image->GetDesc();
+        const Uint3 extent{
+            std::max(desc.extent.x >> mip, 1u),
+            std::max(desc.extent.y >> mip, 1u),
+            (desc.type == ImageType::e3D) ? std::max(desc.extent.z >> mip, 1u) : 1u,
+        };
+        const auto subresource_type = (desc.type == ImageType::e3D) ? ImageSubresourceType::e3D 
+                                    : (desc.type == ImageType::e1D) ? ImageSubresourceType::e1D 
+                                    : ImageSubresourceType::e2D;
+
+        // layers of 2D images are copied one by one
+        const auto layer_count = (desc.type == ImageType::e2D) ? desc.extent.z : 1u;
+        const auto layer_size = GetMipSize(desc, mip) / layer_count;
+        for (const auto layer : Counter(layer_count)) {
+            const ImageSubresource subresource{
+                .type = subresource_type,
+                .base_layer = static_cast<uint16_t>(layer),
+                .base_mipmap = static_cast<uint8_t>(mip),
+                .layer_count = 1,
+                .mipmap_level = 1,
+            };
+
+            command_buffer.IUploadData(
+                entry.image, 
+                subresource, 
+                entry.mip_data[mip].data() + layer * layer_size, 
+                extent, 
+                {0, 0, 0});
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "DnmGL/Vulkan/TransientAttachmentPool.hpp"
+
+namespace DnmGL::Vulkan {
+    TransientAttachmentPool::~TransientAttachmentPool() {
+        // framebuffers should be destroyed before the context
+        for (const auto& entry : m_entries | std::views::values) {
+            m_context->DeleteObject(entry.allocation);
+        }
+    }
+
+    std::unique_ptr<Vulkan::Image> TransientAttachmentPool::Acquire(Uint2 extent, ImageUsageFlags usage, DnmGL::ImageFormat format, SampleCount sample_count, uint32_t slot) {
+        const DnmGL::ImageDesc desc{
+            .extent = {extent.x, extent.y, 1},
+            .format = format,
+            .usage_flags = usage,
+            .type = ImageType::e2D,
+            .mipmap_levels = 1,
+            .sample_count = sample_count,
+        };
+
+        const Key key{format, extent.x, extent.y, sample_count, static_cast<uint8_t>(usage), slot};
+        auto [it, is_inserted] = m_entries.try_emplace(key);
+        if (is_inserted) {
+            // images with the same key have the same memory requirements
+            const auto requirements = Vulkan::Image::GetMemoryRequirements(*m_context, desc);
+            it->second.allocation = Allocate(requirements);
+            it->second.size = requirements.size;
+
+            if (!it->second.allocation) {
+                m_entries.erase(it);
+                return std::make_unique<Vulkan::Image>(*m_context, desc);
+            }
+        }
+        else {
+            m_aliased_bytes += it->second.size;
+        }
+
+        ++it->second.ref_count;
+        return std::make_unique<Vulkan::Image>(*m_context, desc, it->second.allocation);
+    }
+
+    void TransientAttachmentPool::Release(VmaAllocation allocation, const Vulkan::Image *image) {
+        const auto it = std::ranges::find_if(m_entries, [allocation] (const auto& pair) { 
+            return pair.second.allocation == allocation; 
+        });
+        if (it == m_entries.end()) return;
+
+        if (--it->second.ref_count) {
+            // a new image may get the same address
+            if (it->second.last_writer == image) it->second.last_writer = nullptr;
+            m_aliased_bytes -= it->second.size;
+            return;
+        }
+
+        // deleted after the image, images are before allocations in the delete order
+        m_context->DeleteObject(allocation);
+        m_entries.erase(it);
+    }
+
+    bool TransientAttachmentPool::MarkWritten(VmaAllocation allocation, const Vulkan::Image *image) {
+        const auto it = std::ranges::find_if(m_entries, [allocation] (const auto& pair) { 
+            return pair.second.allocation == allocation; 
+        });
+        if (it == m_entries.end()) return false;
+
+        // contents are kept only if the image wrote the memory last, the first write has nothing to keep
+        return std::exchange(it->second.last_writer, image) != image;
+    }
+
+    VmaAllocation TransientAttachmentPool::Allocate(const vk::MemoryRequirements& requirements) {
+        const auto allocator = m_context->GetVmaAllocator();
+        const auto *vk_requirements = reinterpret_cast<const VkMemoryRequirements*>(&requirements);
+
+        VmaAllocationCreateInfo alloc_create_info{};
+        alloc_create_info.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        alloc_create_info.priority = 1.f;
+
+        VmaAllocation allocation{};
+
+        // memory type bits may not contain the lazily allocated type
+        if (m_context->GetSupportedFeatures().lazily_allocated_memory) {
+            alloc_create_info.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            if (vmaAllocateMemory(allocator, vk_requirements, &alloc_create_info, &allocation, nullptr) == VK_SUCCESS) {
+                m_context->TrackAllocation(allocation, MemoryCategory::eAttachment);
+                return allocation;
+            }
+        }
+
+        alloc_create_info.usage = VMA_MEMORY_USAGE_UNKNOWN;
+        alloc_create_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        const auto result = (vk::Result)vmaAllocateMemory(allocator, vk_requirements, &alloc_create_info, &allocation, nullptr);
+        if (result != vk::Result::eSuccess) {
+            m_context->Message("vmaAllocateMemory allocate transient attachment memory failed", MessageType::eOutOfMemory);
+            return VK_NULL_HANDLE;
+        }
+
+        m_context->TrackAllocation(allocation, MemoryCategory::eAttachment);
+        return allocation;
+    }
+}